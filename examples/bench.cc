@@ -0,0 +1,687 @@
+#include "steno.hh"
+#include "steno_parsers.hh"
+#include "steno_translator.hh"
+#include "steno_binary.hh"
+#include "steno_stack.hh"
+#include "steno_shared.hh"
+#include "steno_reverse.hh"
+#include "synthetic.hh"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Microbenchmarks to track across commits. Some measure the same thing
+// done two ways, to compare them. Run through 'make bench.json' for
+// results to diff.
+
+/* ~~ Heap Accounting ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Every allocation is prefixed with its size, so we can track live bytes.
+// Parsing runs on several threads, so the counts are atomic, and every form
+// of new and delete is replaced, so each allocation meets its own release.
+namespace {
+	std::atomic<std::size_t> liveBytes = 0, liveCount = 0;
+
+	// The prefix is a whole alignment, so what follows it stays aligned.
+	std::size_t prefixFor(std::size_t alignment) {
+		return std::max(alignment, alignof(std::max_align_t));
+	}
+
+	void* allocate(std::size_t n, std::size_t alignment) noexcept {
+		std::size_t const prefix = prefixFor(alignment);
+		std::size_t const total = (n + prefix + alignment-1) / alignment * alignment;
+		auto* p = static_cast<char*>(alignment > alignof(std::max_align_t)
+		?	std::aligned_alloc(alignment, total)
+		:	std::malloc(total));
+		if (!p) return nullptr;
+		p += prefix;
+		reinterpret_cast<std::size_t*>(p)[-1] = n;
+		liveBytes.fetch_add(n, std::memory_order_relaxed);
+		liveCount.fetch_add(1, std::memory_order_relaxed);
+		return p;
+	}
+
+	// Out of line, or GCC sees free() meet operator new and warns.
+	[[gnu::noinline]] void release(void* p, std::size_t alignment) noexcept {
+		if (!p) return;
+		auto* q = static_cast<char*>(p);
+		liveBytes.fetch_sub(reinterpret_cast<std::size_t*>(q)[-1], std::memory_order_relaxed);
+		liveCount.fetch_sub(1, std::memory_order_relaxed);
+		std::free(q - prefixFor(alignment));
+	}
+
+	void* allocateOrThrow(std::size_t n, std::size_t alignment) {
+		if (void* p = allocate(n, alignment)) return p;
+		throw std::bad_alloc {};
+	}
+
+	constexpr std::size_t DefaultAlignment = alignof(std::max_align_t);
+}
+
+void* operator new  (std::size_t n) { return allocateOrThrow(n, DefaultAlignment); }
+void* operator new[](std::size_t n) { return allocateOrThrow(n, DefaultAlignment); }
+void* operator new  (std::size_t n, std::align_val_t a) { return allocateOrThrow(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return allocateOrThrow(n, std::size_t(a)); }
+void* operator new  (std::size_t n, std::nothrow_t const&) noexcept { return allocate(n, DefaultAlignment); }
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept { return allocate(n, DefaultAlignment); }
+void* operator new  (std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept { return allocate(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept { return allocate(n, std::size_t(a)); }
+
+void operator delete  (void* p) noexcept { release(p, DefaultAlignment); }
+void operator delete[](void* p) noexcept { release(p, DefaultAlignment); }
+void operator delete  (void* p, std::size_t) noexcept { release(p, DefaultAlignment); }
+void operator delete[](void* p, std::size_t) noexcept { release(p, DefaultAlignment); }
+void operator delete  (void* p, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete  (void* p, std::size_t, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { release(p, std::size_t(a)); }
+void operator delete  (void* p, std::nothrow_t const&) noexcept { release(p, DefaultAlignment); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { release(p, DefaultAlignment); }
+void operator delete  (void* p, std::align_val_t a, std::nothrow_t const&) noexcept { release(p, std::size_t(a)); }
+void operator delete[](void* p, std::align_val_t a, std::nothrow_t const&) noexcept { release(p, std::size_t(a)); }
+
+/* ~~ Inputs ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// The same made-up entries on every run, kept for every benchmark to use.
+steno::Dictionary const& dictionaryOf(std::size_t size) {
+	static std::map<std::size_t, steno::Dictionary> cache {};
+	auto& result = cache[size];
+	if (result.size() != size) {
+		synthetic::Options options {};
+		options.size = size;
+		result = synthetic::generate(options);
+	}
+	return result;
+}
+
+// Some of the entries in a random order, to look up or insert.
+std::vector<steno::Brief> shuffled(std::size_t size, std::size_t count) {
+	auto const& dict = dictionaryOf(size);
+	synthetic::Random random {5678};
+	std::vector<steno::Brief> result {};
+	for (std::size_t i=0; i<count; i++) result.push_back(dict.begin()[random.next() % dict.size()]);
+	return result;
+}
+
+std::vector<std::string> strokeStrings() {
+	std::vector<std::string> result {};
+	for (auto const& entry : dictionaryOf(1 << 12)) {
+		for (auto stroke : entry.phrase()) result.push_back(toString(stroke));
+	}
+	return result;
+}
+
+// Phrases of random entries, each followed by one that isn't there.
+std::vector<steno::Phrase> lookups(std::size_t size, std::size_t count) {
+	std::vector<steno::Phrase> result {};
+	for (auto& entry : shuffled(size, count / 2)) {
+		result.push_back(entry.phrase());
+		entry.phrase().back() ^= steno::Key::_Z;
+		result.push_back(entry.phrase());
+	}
+	return result;
+}
+
+std::string textOf(steno::Dictionary const& dict, steno::FileType type) {
+	std::ostringstream out {};
+	steno::writeDictionary(out, dict, type);
+	return std::move(out).str();
+}
+
+// From a thousand entries to a million, as large as real dictionaries get.
+void sizes(benchmark::internal::Benchmark* b) {
+	b->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+}
+
+/* ~~ Strokes ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void StrokeParse(benchmark::State& state) {
+	auto const text = strokeStrings();
+	for (auto _ : state) {
+		for (auto const& s : text) benchmark::DoNotOptimize(steno::Stroke {std::string_view {s}});
+	}
+	state.SetItemsProcessed(state.iterations() * text.size());
+}
+BENCHMARK(StrokeParse);
+
+void StrokeToString(benchmark::State& state) {
+	std::vector<steno::Stroke> strokes {};
+	for (auto const& s : strokeStrings()) strokes.emplace_back(s);
+	for (auto _ : state) {
+		for (auto stroke : strokes) benchmark::DoNotOptimize(toString(stroke));
+	}
+	state.SetItemsProcessed(state.iterations() * strokes.size());
+}
+BENCHMARK(StrokeToString);
+
+void StrokeParseBulk(benchmark::State& state) {
+	auto const text = strokeStrings();
+	std::vector<std::string_view> const views {text.begin(), text.end()};
+	std::vector<steno::Stroke> strokes (views.size());
+	for (auto _ : state) {
+		steno::parseStrokes(views, strokes);
+		benchmark::DoNotOptimize(strokes.data());
+	}
+	state.SetItemsProcessed(state.iterations() * views.size());
+}
+BENCHMARK(StrokeParseBulk);
+
+void StrokeFormatTo(benchmark::State& state) {
+	std::vector<steno::Stroke> strokes {};
+	for (auto const& s : strokeStrings()) strokes.emplace_back(s);
+	char text[steno::Stroke::KeyCount];
+	for (auto _ : state) {
+		for (auto stroke : strokes) benchmark::DoNotOptimize(steno::formatTo(text, stroke));
+	}
+	state.SetItemsProcessed(state.iterations() * strokes.size());
+}
+BENCHMARK(StrokeFormatTo);
+
+void StrokeStream(benchmark::State& state) {
+	std::vector<steno::Stroke> strokes {};
+	for (auto const& s : strokeStrings()) strokes.emplace_back(s);
+	for (auto _ : state) {
+		std::ostringstream output {};
+		for (auto stroke : strokes) output << stroke << '\n';
+		benchmark::DoNotOptimize(output.tellp());
+	}
+	state.SetItemsProcessed(state.iterations() * strokes.size());
+}
+BENCHMARK(StrokeStream);
+
+/* ~~ Phrases ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void PhraseParse(benchmark::State& state) {
+	std::vector<std::string> text {};
+	for (auto const& entry : dictionaryOf(1 << 12)) text.push_back(toString(entry.phrase()));
+	for (auto _ : state) {
+		for (auto const& s : text) benchmark::DoNotOptimize(steno::Phrase (std::string_view {s}));
+	}
+	state.SetItemsProcessed(state.iterations() * text.size());
+}
+BENCHMARK(PhraseParse);
+
+// How evenly the hash spreads a large dictionary over a power of two
+// buckets, next to what a random function would give at the same load.
+void hashQuality(benchmark::State& state, auto hash) {
+	auto const& dict = dictionaryOf(1 << 20);
+	std::size_t buckets = 1;
+	while (buckets < dict.size()) buckets *= 2;
+	std::vector<std::size_t> count (buckets);
+	for (auto const& entry : dict) count[hash(entry.phrase()) % buckets]++;
+
+	double const load = double(dict.size()) / buckets;
+	std::size_t empty = 0, largest = 0, probes = 0;
+	for (auto c : count) {
+		empty += (c == 0);
+		largest = std::max(largest, c);
+		probes += c * (c + 1) / 2;
+	}
+	state.counters["empty"] = double(empty) / buckets;
+	state.counters["empty_random"] = std::exp(-load);
+	state.counters["largest"] = largest;
+	state.counters["probes"] = double(probes) / dict.size();
+	state.counters["probes_random"] = 1 + load/2;
+}
+
+void PhraseHash(benchmark::State& state) {
+	auto const& dict = dictionaryOf(1 << 12);
+	for (auto _ : state) {
+		for (auto const& entry : dict) {
+			benchmark::DoNotOptimize(std::hash<steno::Phrase> {} (entry.phrase()));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+	hashQuality(state, std::hash<steno::Phrase> {});
+}
+BENCHMARK(PhraseHash);
+
+// The hash as it was originally written, for comparison.
+std::size_t legacyHash(steno::Phrase const& x) {
+	std::size_t seed = x.size();
+	for ([[maybe_unused]] auto stroke : x) {
+		seed ^= x + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+	}
+	return seed;
+}
+
+void PhraseHashLegacy(benchmark::State& state) {
+	auto const& dict = dictionaryOf(1 << 12);
+	for (auto _ : state) {
+		for (auto const& entry : dict) benchmark::DoNotOptimize(legacyHash(entry.phrase()));
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+	hashQuality(state, legacyHash);
+}
+BENCHMARK(PhraseHashLegacy);
+
+// Copying every phrase of a dictionary, and what those copies keep on the heap.
+void PhraseCopy(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	double bytes = 0, count = 0;
+	for (auto _ : state) {
+		std::vector<steno::Phrase> phrases {};
+		phrases.reserve(dict.size());
+		std::size_t const bytesBefore = liveBytes, countBefore = liveCount;
+		for (auto const& entry : dict) phrases.push_back(entry.phrase());
+		bytes = double(liveBytes - bytesBefore) / dict.size();
+		count = double(liveCount - countBefore) / dict.size();
+		benchmark::DoNotOptimize(phrases.data());
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+	state.counters["sizeof"] = sizeof (steno::Phrase);
+	state.counters["heap_bytes"] = bytes;
+	state.counters["allocations"] = count;
+}
+BENCHMARK(PhraseCopy)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+/* ~~ Dictionaries ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void DictionaryInsert(benchmark::State& state) {
+	auto const entries = shuffled(state.range(0), state.range(0));
+	for (auto _ : state) {
+		steno::Dictionary dict {};
+		for (auto const& entry : entries) dict.insert(entry);
+		benchmark::DoNotOptimize(dict.size());
+	}
+	state.SetItemsProcessed(state.iterations() * entries.size());
+}
+// Entries are kept sorted, so inserting one at a time is quadratic; past
+// some tens of thousands it's all moving entries along.
+BENCHMARK(DictionaryInsert)->RangeMultiplier(32)->Range(1 << 10, 1 << 15)
+->Unit(benchmark::kMillisecond);
+
+void DictionaryFind(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	auto const lookups = shuffled(state.range(0), 1 << 12);
+	for (auto _ : state) {
+		for (auto const& entry : lookups) benchmark::DoNotOptimize(dict.find(entry.phrase()));
+	}
+	state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+BENCHMARK(DictionaryFind)->Apply(sizes);
+
+// Half of the phrases looked up are missing, and the index is optional.
+void dictionaryLookups(benchmark::State& state, auto&& lookup) {
+	auto dict = dictionaryOf(state.range(0));
+	if (state.range(1)) dict.buildIndex();
+	auto const queries = lookups(state.range(0), 1 << 12);
+	std::vector<steno::Dictionary::const_iterator> found (queries.size());
+	for (auto _ : state) {
+		lookup(std::as_const(dict), queries, found);
+		benchmark::DoNotOptimize(found.data());
+	}
+	state.SetItemsProcessed(state.iterations() * queries.size());
+}
+
+void indexedSizes(benchmark::internal::Benchmark* b) {
+	b->ArgsProduct({{1 << 10, 1 << 15, 1 << 20}, {0, 1}})->ArgNames({"", "indexed"});
+}
+
+void DictionaryFindEach(benchmark::State& state) {
+	dictionaryLookups(state, [] (auto const& dict, auto const& queries, auto& found) {
+		for (std::size_t i=0; i<queries.size(); i++) found[i] = dict.find(queries[i]);
+	});
+}
+BENCHMARK(DictionaryFindEach)->Apply(indexedSizes);
+
+void DictionaryFindMany(benchmark::State& state) {
+	dictionaryLookups(state, [] (auto const& dict, auto const& queries, auto& found) {
+		dict.findMany(queries, found);
+	});
+}
+BENCHMARK(DictionaryFindMany)->Apply(indexedSizes);
+
+void DictionaryMerge(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	auto const middle = dict.begin() + dict.size() / 2;
+	steno::Dictionary const left {dict.begin(), middle}, right {middle, dict.end()};
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto a = left, b = right;
+		state.ResumeTiming();
+		a.merge(b);
+		benchmark::DoNotOptimize(a.size());
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(DictionaryMerge)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+void DictionaryEraseIf(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto copy = dict;
+		state.ResumeTiming();
+		erase_if(copy, [] (steno::Brief const& b) { return b.phrase().size() > 1; });
+		benchmark::DoNotOptimize(copy.size());
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(DictionaryEraseIf)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+void DictionaryEraseIfParallel(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto copy = dict;
+		state.ResumeTiming();
+		copy.eraseIfParallel([] (steno::Brief const& b) { return b.phrase().size() > 1; });
+		benchmark::DoNotOptimize(copy.size());
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(DictionaryEraseIfParallel)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+/* ~~ Translation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void TranslatorStroke(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	// Strokes of random entries, back to back.
+	std::vector<steno::Stroke> strokes {};
+	for (auto const& entry : shuffled(state.range(0), 1 << 16)) {
+		strokes.insert(strokes.end(), entry.phrase().begin(), entry.phrase().end());
+	}
+	steno::Translator translator {dict};
+	for (auto _ : state) {
+		for (auto stroke : strokes) benchmark::DoNotOptimize(translator.translate(stroke).erase);
+	}
+	state.SetItemsProcessed(state.iterations() * strokes.size());
+}
+BENCHMARK(TranslatorStroke)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+/* ~~ Layered and Shared ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// A large main dictionary, with a small user dictionary over it.
+steno::DictionaryStack stackOf(std::size_t size) {
+	auto const& dict = dictionaryOf(size);
+	auto const split = dict.begin() + (dict.size() - std::min<std::size_t>(dict.size(), 1000));
+	return {{dict.begin(), split}, {split, dict.end()}};
+}
+
+void StackFind(benchmark::State& state) {
+	auto const stack = stackOf(state.range(0));
+	// Writing uses the same few thousand phrases over and over.
+	auto const phrases = lookups(std::min<std::size_t>(state.range(0), 1 << 12), 1 << 12);
+	for (auto _ : state) {
+		for (auto const& phrase : phrases) benchmark::DoNotOptimize(stack.find(phrase));
+	}
+	state.SetItemsProcessed(state.iterations() * phrases.size());
+}
+BENCHMARK(StackFind)->Apply(sizes);
+
+// What it takes for one user edit to show up, in a stack or merged anew.
+void StackEdit(benchmark::State& state) {
+	auto stack = stackOf(state.range(0));
+	for (auto _ : state) {
+		stack.insert(1, {{"TEFT"}, "test"});
+		benchmark::DoNotOptimize(stack.contains(steno::Phrase {"TEFT"}));
+	}
+}
+BENCHMARK(StackEdit)->Apply(sizes);
+
+void StackEditMerged(benchmark::State& state) {
+	auto const stack = stackOf(state.range(0));
+	for (auto _ : state) {
+		auto merged = stack.layer(0);
+		merged.merge(steno::Dictionary {stack.layer(1)});
+		merged[steno::Phrase {"TEFT"}] = "test";
+		benchmark::DoNotOptimize(merged.size());
+	}
+}
+BENCHMARK(StackEditMerged)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// With enough edits for the overlay to be of a typical size.
+steno::SharedDictionary& sharedOf(std::size_t size) {
+	static std::map<std::size_t, steno::SharedDictionary> cache {};
+	auto [it, added] = cache.try_emplace(size, dictionaryOf(size));
+	if (added) {
+		for (auto const& entry : shuffled(size, 500)) it->second.insert({entry.phrase(), "edited"});
+	}
+	return it->second;
+}
+
+void SharedFind(benchmark::State& state) {
+	auto const snapshot = sharedOf(state.range(0)).snapshot();
+	auto const phrases = lookups(state.range(0), 1 << 12);
+	for (auto _ : state) {
+		for (auto const& phrase : phrases) benchmark::DoNotOptimize(snapshot.find(phrase));
+	}
+	state.SetItemsProcessed(state.iterations() * phrases.size());
+}
+BENCHMARK(SharedFind)->Apply(sizes);
+
+void SharedSnapshotFind(benchmark::State& state) {
+	auto const& shared = sharedOf(state.range(0));
+	auto const phrases = lookups(state.range(0), 1 << 12);
+	for (auto _ : state) {
+		for (auto const& phrase : phrases) benchmark::DoNotOptimize(shared.snapshot().find(phrase));
+	}
+	state.SetItemsProcessed(state.iterations() * phrases.size());
+}
+BENCHMARK(SharedSnapshotFind)->Apply(sizes);
+
+void SharedEdit(benchmark::State& state) {
+	auto& shared = sharedOf(state.range(0));
+	auto const entries = shuffled(state.range(0), 1000);
+	std::size_t i = 0;
+	for (auto _ : state) shared.insert({entries[i++ % entries.size()].phrase(), "edited again"});
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(SharedEdit)->Apply(sizes);
+
+/* ~~ Reverse Lookup ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+std::vector<std::string> textsOf(std::size_t size) {
+	std::vector<std::string> result {};
+	for (auto const& entry : shuffled(size, 1 << 12)) result.push_back(entry.text());
+	return result;
+}
+
+// The same texts as running text, split into tokens at spaces.
+std::vector<std::string> tokensOf(std::size_t size) {
+	std::vector<std::string> result {};
+	for (auto const& text : textsOf(size)) {
+		for (std::size_t i=0, j=0; i<text.size(); i=j+1) {
+			j = std::min(text.find(' ', i), text.size());
+			if (j > i) result.push_back(text.substr(i, j - i));
+		}
+	}
+	return result;
+}
+
+void ReverseIndexBuild(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	for (auto _ : state) benchmark::DoNotOptimize(steno::ReverseIndex {dict}.size());
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(ReverseIndexBuild)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// What reverse_translate used to do, a node per entry.
+void ReverseMultimapBuild(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	for (auto _ : state) {
+		std::multimap<std::string, steno::Phrase> map {};
+		for (auto const& [phrase, text] : dict) map.insert({text, phrase});
+		benchmark::DoNotOptimize(map.size());
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(ReverseMultimapBuild)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+void ReverseIndexBest(benchmark::State& state) {
+	steno::ReverseIndex const index {dictionaryOf(state.range(0))};
+	auto const texts = textsOf(state.range(0));
+	for (auto _ : state) {
+		for (auto const& text : texts) benchmark::DoNotOptimize(index.best(text));
+	}
+	state.SetItemsProcessed(state.iterations() * texts.size());
+}
+BENCHMARK(ReverseIndexBest)->Apply(sizes);
+
+void ReverseTranslatorBuild(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	for (auto _ : state) benchmark::DoNotOptimize(steno::ReverseTranslator {dict}.lookahead());
+	state.SetItemsProcessed(state.iterations() * dict.size());
+}
+BENCHMARK(ReverseTranslatorBuild)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+void ReverseTranslate(benchmark::State& state) {
+	steno::ReverseTranslator translator {dictionaryOf(state.range(0))};
+	auto const tokens = tokensOf(state.range(0));
+	for (auto _ : state) {
+		for (auto const& token : tokens) benchmark::DoNotOptimize(translator.push(token).size());
+		benchmark::DoNotOptimize(translator.finish().size());
+	}
+	state.SetItemsProcessed(state.iterations() * tokens.size());
+}
+BENCHMARK(ReverseTranslate)->Apply(sizes);
+
+// The tokens as running text, the way reverse_translate reads it.
+std::string proseOf(std::size_t size) {
+	auto const tokens = tokensOf(size);
+	std::string result {};
+	for (std::size_t i=0; i<tokens.size(); i++) result += tokens[i] + (i % 12 == 11? ". ": " ");
+	return result;
+}
+
+// What reverse_translate used to do.
+void TokenizeRegex(benchmark::State& state) {
+	auto const text = proseOf(1 << 15);
+	std::regex const pattern {R"([A-Za-z]+|[^\s])"};
+	std::size_t count = 0;
+	for (auto _ : state) {
+		using Iter = std::sregex_iterator;
+		for (Iter it {text.begin(), text.end(), pattern}, end {}; it!=end; ++it, ++count) {
+			benchmark::DoNotOptimize(it->str());
+		}
+	}
+	state.SetItemsProcessed(count);
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(TokenizeRegex);
+
+void TokenizeStream(benchmark::State& state) {
+	auto const text = proseOf(1 << 15);
+	std::size_t count = 0;
+	for (auto _ : state) {
+		std::istringstream input {text};
+		steno::TextTokenizer lexer {input};
+		while (auto const token = lexer.next()) benchmark::DoNotOptimize(token->size()), ++count;
+	}
+	state.SetItemsProcessed(count);
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(TokenizeStream);
+
+/* ~~ Parsers ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+template <steno::FileType FT>
+void EntryIterator(benchmark::State& state) {
+	std::ostringstream out {};
+	steno::writeDictionary(out, dictionaryOf(state.range(0)), FT);
+	auto const text = std::move(out).str();
+	for (auto _ : state) {
+		std::istringstream in {text};
+		std::size_t count = 0;
+		for (auto it = steno::EntryIterator<FT> {in}; it != steno::EntryIterator<FT> {}; ++it) {
+			count += (*it).phrase().size();
+		}
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK_TEMPLATE(EntryIterator, steno::Plain)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(EntryIterator, steno::Json)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(EntryIterator, steno::Rtf)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+void BufferParserJson(benchmark::State& state) {
+	auto const text = textOf(dictionaryOf(state.range(0)), steno::Json);
+	for (auto _ : state) {
+		steno::BufferParser<steno::Json> parser {text};
+		std::size_t count = 0;
+		while (parser.next()) count += parser.text().size();
+		benchmark::DoNotOptimize(count);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BufferParserJson)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+// Whole dictionaries from JSON: from a stream, with the file type detected
+// or given, or from a buffer on a number of threads.
+void ParseStream(benchmark::State& state) {
+	auto const text = textOf(dictionaryOf(state.range(0)), steno::Json);
+	for (auto _ : state) {
+		std::istringstream input {text};
+		auto const dict = state.range(1)
+		?	steno::parseDictionary(input)
+		:	steno::parseDictionary(input, steno::Json);
+		benchmark::DoNotOptimize(dict->size());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(ParseStream)->ArgsProduct({{1 << 10, 1 << 15, 1 << 20}, {0, 1}})
+->ArgNames({"", "detect"})->Unit(benchmark::kMillisecond);
+
+void ParseBuffer(benchmark::State& state) {
+	auto const text = textOf(dictionaryOf(state.range(0)), steno::Json);
+	for (auto _ : state) {
+		auto const dict = steno::parseDictionaryParallel(text, steno::Json, state.range(1));
+		benchmark::DoNotOptimize(dict->size());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(ParseBuffer)->ArgsProduct({{1 << 10, 1 << 15, 1 << 20}, {1, 2, 4, 8}})
+->ArgNames({"", "threads"})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+template <steno::FileType FT>
+void WriteDictionary(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	std::size_t bytes = 0;
+	for (auto _ : state) {
+		std::ostringstream output {};
+		steno::writeDictionary(output, dict, FT);
+		bytes += output.tellp();
+	}
+	state.SetItemsProcessed(state.iterations() * dict.size());
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK_TEMPLATE(WriteDictionary, steno::Plain)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(WriteDictionary, steno::Json)->Apply(sizes)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(WriteDictionary, steno::Rtf)->Apply(sizes)->Unit(benchmark::kMillisecond);
+
+/* ~~ Loading ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// From opening a binary dictionary to the first lookup, to set against
+// ParseStream, the time to read the same entries as JSON.
+void LoadBinary(benchmark::State& state) {
+	auto const& dict = dictionaryOf(state.range(0));
+	auto const path = std::filesystem::temp_directory_path() / "steno-bench.dict";
+	{
+		std::ofstream output {path, std::ios::binary};
+		steno::writeBinary(output, dict);
+	}
+	for (auto _ : state) {
+		auto const mapped = steno::MappedDictionary::open(path.c_str());
+		benchmark::DoNotOptimize(mapped->contains(dict.begin()->phrase()));
+	}
+	std::filesystem::remove(path);
+}
+BENCHMARK(LoadBinary)->Apply(sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,36 @@
+#include "steno.hh"
+#include "steno_parsers.hh"
+#include "steno_binary.hh"
+#include <iostream>
+#include <fstream>
+
+// Merges any number of dictionaries, later ones taking priority, into one
+// binary file for steno::MappedDictionary to load.
+int main(int argc, char const* argv[]) {
+	if (argc < 3) {
+		std::cerr << "Usage: " << argv[0] << " OUTPUT DICTIONARY...\n";
+		return 1;
+	}
+	std::vector<std::string> paths {argv+2, argv+argc};
+	steno::Dictionary dict {};
+	for (auto path : paths) {
+		if (std::ifstream file {path}) {
+			if (auto result = steno::parseDictionary(file)) dict.merge(std::move(*result));
+			else { std::cerr << "Unable to parse dictionary " << path << ".\n"; return 1; }
+		}
+		else { std::cerr << "Unable to open dictionary " << path << ".\n"; return 1; }
+	}
+
+	std::ofstream output {argv[1], std::ios::binary};
+	if (!steno::writeBinary(output, dict) || !output.flush()) {
+		std::cerr << "Unable to write " << argv[1] << ".\n";
+		return 1;
+	}
+	// Make sure what we wrote can be read back.
+	auto const mapped = steno::MappedDictionary::open(argv[1]);
+	if (!mapped || mapped->size() != dict.size()) {
+		std::cerr << "Unable to read back " << argv[1] << ".\n";
+		return 1;
+	}
+	std::cout << argv[1] << " " << dict.size() << " entries.\n";
+}
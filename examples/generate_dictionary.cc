@@ -0,0 +1,121 @@
+#include "steno.hh"
+#include "steno_parsers.hh"
+#include "synthetic.hh"
+#include <iostream>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// Writes out a made-up dictionary, the same every time for the same options.
+//   generate_dictionary --size 1000000 --format rtf --seed 7 > big.rtf
+
+char const* const Usage = R"(Usage: generate_dictionary [OPTION VALUE]...
+  --size N               Entries to generate (100000)
+  --seed N               Seed for the random numbers (1)
+  --format FORMAT        plain, json or rtf (json)
+  --output PATH          Where to write it, instead of stdout
+  --phrase-lengths W,... Weights for phrases of 1, 2... strokes
+  --key-frequencies P,.. Chance of each of the 23 keys in a stroke
+  --text-words W,...     Weights for texts of 1, 2... words
+  --word-lengths W,...   Weights for words of 1, 2... letters
+)";
+
+std::optional<uint64_t> parseNumber(std::string const& s) {
+	char* end = nullptr;
+	auto const n = std::strtoull(s.c_str(), &end, 10);
+	if (s.empty() || *end) return std::nullopt;
+	return n;
+}
+
+// A list of at least one non-negative number, with at least one non-zero.
+std::optional<std::vector<double>> parseWeights(std::string const& s) {
+	std::vector<double> result {};
+	bool any = false;
+	for (char const* p = s.c_str(); ; p++) {
+		char* end = nullptr;
+		double const w = std::strtod(p, &end);
+		if (end == p || w < 0) return std::nullopt;
+		result.push_back(w);
+		any |= w > 0;
+		p = end;
+		if (*p == '\0') break;
+		if (*p != ',') return std::nullopt;
+	}
+	if (!any) return std::nullopt;
+	return result;
+}
+
+int main(int argc, char const* argv[]) {
+	std::vector<std::string> args {argv+1, argv+argc};
+	synthetic::Options options {};
+	steno::FileType format = steno::Json;
+	std::string output {};
+
+	for (std::size_t i=0; i<args.size(); i+=2) {
+		auto const& name = args[i];
+		if (i+1 == args.size()) {
+			std::cerr << "No value for " << name << "\n" << Usage;
+			return 1;
+		}
+		auto const& value = args[i+1];
+		bool valid = true;
+		if (name == "--size" || name == "--seed") {
+			auto const n = parseNumber(value);
+			if (n && name == "--size") options.size = *n;
+			if (n && name == "--seed") options.seed = *n;
+			valid = n.has_value();
+		}
+		else if (name == "--format") {
+			if      (value == "plain") format = steno::Plain;
+			else if (value == "json")  format = steno::Json;
+			else if (value == "rtf")   format = steno::Rtf;
+			else valid = false;
+		}
+		else if (name == "--output") output = value;
+		else if (name == "--key-frequencies") {
+			auto const p = parseWeights(value);
+			valid = p && p->size() == options.keyFrequencies.size()
+			&&  std::ranges::all_of(*p, [] (double x) { return x <= 1; });
+			if (valid) std::ranges::copy(*p, options.keyFrequencies.begin());
+		}
+		else if (name == "--phrase-lengths" || name == "--text-words" || name == "--word-lengths") {
+			auto const w = parseWeights(value);
+			if (w) {
+				(name == "--phrase-lengths"? options.phraseLengths:
+				 name == "--text-words"? options.textWords: options.wordLengths) = *w;
+			}
+			valid = w.has_value();
+		}
+		else {
+			std::cerr << "Unknown option " << name << "\n" << Usage;
+			return 1;
+		}
+		if (!valid) {
+			std::cerr << "Invalid value for " << name << ": " << value << "\n";
+			return 1;
+		}
+	}
+
+	auto const dict = synthetic::generate(options);
+	if (dict.size() < options.size) {
+		std::cerr << "Only " << dict.size() << " different phrases turned up, not "
+		          << options.size << ". Allow more keys or longer phrases.\n";
+		return 1;
+	}
+	std::ofstream file {};
+	if (!output.empty()) {
+		file.open(output, std::ios::binary);
+		if (!file) {
+			std::cerr << "Unable to open " << output << "\n";
+			return 1;
+		}
+	}
+	std::ostream& out = output.empty()? std::cout: file;
+	if (!steno::writeDictionary(out, dict, format) || !out.flush()) {
+		std::cerr << "Unable to write the dictionary\n";
+		return 1;
+	}
+	std::cerr << dict.size() << " entries.\n";
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "steno.hh"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Made-up dictionaries shaped like real ones, for benchmarks and stress
+// tests at sizes no real dictionary comes in. The same options and seed
+// give the same dictionary on any machine, as the random numbers and their
+// distributions are all our own rather than the standard library's.
+namespace synthetic {
+
+// Sebastiano Vigna's SplitMix64: small, fast and well spread.
+class Random {
+	uint64_t m_state;
+
+public:
+	Random(uint64_t seed)
+	:	m_state{seed} {}
+
+	uint64_t next() {
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+		return z ^ (z >> 31);
+	}
+
+	// Uniform over [0, 1), from the top 53 bits.
+	double unit() { return (next() >> 11) * 0x1.0p-53; }
+	bool chance(double p) { return unit() < p; }
+};
+
+// Picks an index with chance proportional to its weight.
+class Weighted {
+	std::vector<double> m_cumulative {};
+
+public:
+	Weighted(std::vector<double> const& weights) {
+		double total = 0;
+		for (double w : weights) m_cumulative.push_back(total += std::max(w, 0.0));
+	}
+
+	std::size_t operator()(Random& random) const {
+		double const x = random.unit() * m_cumulative.back();
+		auto const it = std::upper_bound(m_cumulative.begin(), m_cumulative.end(), x);
+		return std::min<std::size_t>(it - m_cumulative.begin(), m_cumulative.size() - 1);
+	}
+};
+
+struct Options {
+	std::size_t size = 100'000;
+	uint64_t seed = 1;
+	// Weights for phrases of 1, 2, 3... strokes.
+	std::vector<double> phraseLengths {45, 38, 12, 4, 1};
+	// The chance of each key being in a stroke, in steno order: #, S-, T-,
+	// K-, P-, W-, H-, R-, A, O, *, E, U, -F, -R, -P, -B, -L, -G, -T, -S,
+	// -D, -Z. Roughly as in the strokes of Plover's main dictionary.
+	std::array<double, 23> keyFrequencies {
+		0.01, 0.20, 0.25, 0.17, 0.22, 0.17, 0.28, 0.30,
+		0.28, 0.30, 0.10, 0.35, 0.30,
+		0.12, 0.12, 0.15, 0.15, 0.15, 0.17, 0.20, 0.17, 0.12, 0.03,
+	};
+	// Weights for texts of 1, 2, 3... words.
+	std::vector<double> textWords {70, 20, 7, 3};
+	// Weights for words of 1, 2, 3... letters, as in English prose.
+	std::vector<double> wordLengths {3, 17, 21, 17, 12, 9, 8, 6, 4, 2, 1};
+};
+
+// Letters weighted as they are in English text.
+inline Weighted const Letters {{
+	8.2, 1.5, 2.8, 4.3, 12.7, 2.2, 2.0, 6.1, 7.0, 0.2, 0.8, 4.0, 2.4,
+	6.7, 7.5, 1.9, 0.1, 6.0, 6.3, 9.1, 2.8, 1.0, 2.4, 0.2, 2.0, 0.1,
+}};
+
+inline steno::Stroke stroke(Random& random, Options const& options) {
+	uint32_t keys = 0;
+	while (keys == 0) {
+		for (unsigned k=0; k<options.keyFrequencies.size(); k++) {
+			// From the top bit down, as the keys run in steno order.
+			if (random.chance(options.keyFrequencies[k])) keys |= 1u << (22 - k);
+		}
+	}
+	return steno::Stroke {steno::FromBits, keys};
+}
+
+inline std::string text(Random& random, Weighted const& words, Weighted const& lengths) {
+	std::string result {};
+	for (std::size_t w = words(random) + 1; w--; /**/) {
+		for (std::size_t n = lengths(random) + 1; n--; /**/) result += 'a' + Letters(random);
+		if (w) result += ' ';
+	}
+	return result;
+}
+
+// Gives up after this many tries in a row turn up no new phrase, as the
+// options may not allow as many different phrases as were asked for.
+inline constexpr std::size_t MaxRepeats = 1 << 16;
+
+// Fewer than options.size entries only when the options ran out of phrases.
+inline steno::Dictionary generate(Options const& options) {
+	Random random {options.seed};
+	Weighted const phraseLengths {options.phraseLengths};
+	Weighted const textWords {options.textWords};
+	Weighted const wordLengths {options.wordLengths};
+
+	steno::Dictionary result {};
+	if (std::ranges::none_of(options.keyFrequencies, [] (double p) { return p > 0; })) {
+		return result;
+	}
+	// Short phrases come up more than once, and only the first is kept.
+	// Everything goes in at the end, as one by one is quadratic.
+	std::unordered_set<steno::Phrase> seen {};
+	std::vector<steno::Brief> entries {};
+	seen.reserve(options.size);
+	entries.reserve(options.size);
+	for (std::size_t repeats=0; entries.size() < options.size && repeats < MaxRepeats; /**/) {
+		steno::Phrase phrase {};
+		for (std::size_t n = phraseLengths(random) + 1; n--; /**/) {
+			phrase.push_back(stroke(random, options));
+		}
+		auto text = synthetic::text(random, textWords, wordLengths);
+		if (!seen.insert(phrase).second) { repeats++; continue; }
+		entries.emplace_back(std::move(phrase), std::move(text));
+		repeats = 0;
+	}
+	result.insert(entries.begin(), entries.end());
+	return result;
+}
+
+} // namespace synthetic
@@ -1,7 +1,10 @@
 #include "steno.hh"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
 #include <iterator>
 #include <concepts>
+#include <new>
 
 // Double parentheses required so our '<' isn't parsed as a less-than.
 #define EXPECT_SAME_TYPE(T, U) EXPECT_TRUE((std::same_as<T, U>))
@@ -12,6 +15,54 @@
     __VA_ARGS__; /*PostCondition*/                                             \
 }
 
+/* ~~ Allocation Counting ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Every allocation in the program is counted, so tests can check what they
+// made. All the forms are replaced together, so each new meets its own delete.
+namespace {
+	std::atomic<std::size_t> allocations {0};
+
+	void* countedAllocation(std::size_t n, std::size_t alignment = 0) noexcept {
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		if (alignment == 0) return std::malloc(n? n: 1);
+		// aligned_alloc() wants a whole number of alignments.
+		return std::aligned_alloc(alignment, std::max<std::size_t>(1, (n + alignment-1) / alignment) * alignment);
+	}
+
+	// Out of line, or GCC sees free() meet operator new and warns.
+	[[gnu::noinline]] void release(void* p) noexcept { std::free(p); }
+}
+
+void* operator new  (std::size_t n) {
+	if (void* p = countedAllocation(n)) return p;
+	throw std::bad_alloc {};
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void* operator new  (std::size_t n, std::align_val_t a) {
+	if (void* p = countedAllocation(n, std::size_t(a))) return p;
+	throw std::bad_alloc {};
+}
+void* operator new[](std::size_t n, std::align_val_t a) { return operator new(n, a); }
+void* operator new  (std::size_t n, std::nothrow_t const&) noexcept { return countedAllocation(n); }
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept { return countedAllocation(n); }
+void* operator new  (std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept
+{ return countedAllocation(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept
+{ return countedAllocation(n, std::size_t(a)); }
+
+void operator delete  (void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete  (void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete  (void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete  (void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete  (void* p, std::nothrow_t const&) noexcept { release(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { release(p); }
+void operator delete  (void* p, std::align_val_t, std::nothrow_t const&) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept { release(p); }
+
 /* ~~ Key Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 TEST(StenoKey, Addition) {
@@ -137,6 +188,35 @@ TEST(StenoStroke, BadInputString) {
 	// TODO
 }
 
+TEST(StenoStroke, BulkParsing) {
+	// Every string of up to three characters that could mean anything,
+	// plus a few that couldn't, must parse exactly as the constructor does.
+	std::string_view const alphabet {"#STKPWHRAO*EUFBLGDZ-0123456789 \tq\0", 35};
+	std::vector<std::string> inputs {""};
+	for (std::size_t first=0; first<inputs.size() && inputs[first].size() < 3; first++) {
+		for (char c : alphabet) inputs.push_back(inputs[first] + c);
+	}
+	for (auto s : {"SPROUTS", "STKPWHRAO*EUFRPBLGTSDZ", "#STKPWHR-FRPBLGTSDZ", "1-9", "0EU"}) {
+		inputs.push_back(s);
+	}
+	std::vector<std::string_view> views {inputs.begin(), inputs.end()};
+	std::vector<steno::Stroke> strokes (views.size());
+	steno::parseStrokes(views, strokes);
+	for (std::size_t i=0; i<views.size(); i++) {
+		steno::Stroke const expected {views[i]};
+		ASSERT_EQ(strokes[i].raw(), expected.raw()) << "\"" << views[i] << "\"";
+		ASSERT_EQ(strokes[i].failed(), expected.failed()) << "\"" << views[i] << "\"";
+	}
+
+	// Or split out of a delimited buffer, which may not all fit.
+	steno::Stroke split[2] {};
+	EXPECT_EQ(steno::parseStrokes("KAT/-S/TKOG", split), 3);
+	EXPECT_EQ(split[0], steno::Stroke {"KAT"});
+	EXPECT_EQ(split[1], steno::Stroke {"-S"});
+	EXPECT_EQ(steno::parseStrokes("KAT TKOG", split, ' '), 2);
+	EXPECT_EQ(split[1], steno::Stroke {"TKOG"});
+}
+
 TEST(StenoStroke, Getters) {
 	steno::Stroke stroke {"SPROUTS"};
 	EXPECT_EQ(stroke.raw(), 0b01001001010010000001100'000000000);
@@ -328,6 +408,7 @@ TEST(StenoStroke, UseWithMaps) {
 }
 
 #include <sstream>
+#include <iomanip>
 TEST(StenoStroke, ToString) {
 	steno::Stroke array[] = {
 		{"         *EU          "},
@@ -376,6 +457,42 @@ TEST(StenoStroke, ToString) {
 	}
 }
 
+TEST(StenoStroke, FormatTo) {
+	using enum steno::Format;
+	char buffer[steno::Stroke::KeyCount];
+	auto const format = [&] (steno::Stroke s, steno::Format f = StrokeDefault) {
+		return std::string {buffer, steno::formatTo(buffer, s, f)};
+	};
+	EXPECT_EQ(format(steno::Stroke {"12HOURS"}), "1240URS");
+	EXPECT_EQ(format(steno::Stroke {"12HOURS"}, Wide|Alpha), "#ST   H  O  U R     S  ");
+	EXPECT_EQ(format(~steno::NoStroke, Alpha), "#STKPWHRAO*EUFRPBLGTSDZ");
+	EXPECT_EQ(format(steno::NoStroke), "-");
+	// Packed is always wide without the spaces.
+	for (uint32_t bits=0; bits < (1u << 23); bits += 997) {
+		steno::Stroke const stroke {steno::FromBits, bits};
+		for (auto digits : {Numeric, Alpha}) {
+			auto wide = format(stroke, Wide|digits);
+			std::erase(wide, ' ');
+			ASSERT_EQ(format(stroke, Packed|digits), wide) << bits;
+		}
+	}
+
+	steno::Brief const brief {{"KAT/#-T/-Z"}, "cat"};
+	std::string text = "";
+	steno::formatTo(std::back_inserter(text), brief);
+	EXPECT_EQ(text, "KAT/9/-Z, cat");
+
+	// Padding applies to the whole phrase, not its first stroke.
+	std::stringstream ss {};
+	ss << std::setw(12) << brief.phrase() << "|" << brief.phrase();
+	EXPECT_EQ(ss.str(), "    KAT/9/-Z|KAT/9/-Z");
+#ifdef __cpp_lib_format
+	EXPECT_EQ(std::format("{}", brief), "KAT/9/-Z, cat");
+	EXPECT_EQ(std::format("{:a}", brief.phrase()), "KAT/#-T/-Z");
+	EXPECT_EQ(std::format("{:w}", steno::Stroke {"-Z"}), "          -           Z");
+#endif
+}
+
 /* ~~ Phrase Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 // Modeled after https://en.cppreference.com/w/cpp/named_req/SequenceContainer
 
@@ -454,6 +571,44 @@ TEST(StenoPhrase, UseWithMaps) {
 	EXPECT_EQ(seen[{"3"}], false);
 }
 
+TEST(StenoPhrase, InlineStorage) {
+	using C = steno::Phrase;
+	C shortPhrase {"1/2"};
+	EXPECT_EQ(shortPhrase.capacity(), C::InlineCount);
+
+	// Growing past the inline strokes moves everything to the heap.
+	C longPhrase {};
+	for (std::size_t i=0; i<3*C::InlineCount; i++) longPhrase |= shortPhrase;
+	EXPECT_EQ(longPhrase.size(), 6*C::InlineCount);
+	EXPECT_GT(longPhrase.capacity(), C::InlineCount);
+	EXPECT_EQ(longPhrase[5], steno::Stroke {"2"});
+
+	// Appending a phrase to itself must not read freed memory.
+	C doubled = longPhrase;
+	doubled.insert(doubled.end(), doubled.begin(), doubled.end());
+	EXPECT_EQ(doubled, longPhrase | longPhrase);
+
+	C moved = std::move(longPhrase);
+	EXPECT_EQ(moved.size(), 6*C::InlineCount);
+	EXPECT_TRUE(longPhrase.empty());
+	moved = shortPhrase;
+	EXPECT_EQ(moved, shortPhrase);
+	EXPECT_LT(C {"1/2"}, C {"1/2/3"});
+	EXPECT_LT(C {"1/3/2"}, C {"1/2"});
+}
+
+TEST(StenoPhrase, Hash) {
+	std::hash<steno::Phrase> const hash {};
+	steno::Phrase const phrase {"KOPB/STAPBT/HRAOEU"};
+	std::span<steno::Stroke const> const strokes {phrase.begin(), phrase.end()};
+	EXPECT_EQ(hash(phrase), hash(strokes));
+	// Every stroke and its position has to contribute.
+	EXPECT_NE(hash(phrase), hash(steno::Phrase {"KOPB/STAPBT"}));
+	EXPECT_NE(hash(phrase), hash(steno::Phrase {"HRAOEU/STAPBT/KOPB"}));
+	EXPECT_NE(hash(steno::Phrase {"A"}), hash(steno::Phrase {"O"}));
+	EXPECT_NE(hash(steno::Phrase {"A/-"}), hash(steno::Phrase {"A"}));
+}
+
 TEST(StenoPhrase, ToString) {
 	steno::Phrase phrase {"#O/#S-/#T-/#P-/#H-/#A/#-F/#-P/#-L/#-T"};
 	EXPECT_EQ(steno::toString(phrase), "0/1/2/3/4/5/6/7/8/9");
@@ -701,6 +856,205 @@ TEST(StenoDictionary, Insertion) {
 	}
 }
 
+TEST(StenoDictionary, BulkInsertion) {
+	std::vector<steno::Brief> const Entries = {
+		{{"TWO"}, "two"},
+		{{"WUPB"}, "one"},
+		{{"THRAOE"}, "three"},
+		{{"TWO"}, "2"},
+	};
+	steno::Dictionary dict {{{"WUPB"}, "1"}, {{"TPOUR"}, "four"}};
+	dict.insert(Entries.begin(), Entries.end());
+	EXPECT_EQ(dict.size(), 4);
+	EXPECT_TRUE(std::is_sorted(dict.begin(), dict.end()));
+	// Later entries overwrite earlier ones.
+	EXPECT_EQ(dict[steno::Phrase {"WUPB"}], "one");
+	EXPECT_EQ(dict[steno::Phrase {"TWO"}], "2");
+	EXPECT_EQ(dict[steno::Phrase {"TPOUR"}], "four");
+
+	steno::Dictionary const fromRange {Entries.begin(), Entries.end()};
+	EXPECT_EQ(fromRange.size(), 3);
+	EXPECT_EQ(fromRange.at(steno::Phrase {"TWO"}), "2");
+}
+
+TEST(StenoDictionary, HashIndex) {
+	steno::Dictionary dict {{{"WUPB"}, "one"}, {{"TWO"}, "two"}};
+	dict.buildIndex();
+	EXPECT_TRUE(dict.indexed());
+	auto const numbered = [] (unsigned i) {
+		return steno::Stroke {"TPHUPL"} | steno::Stroke {steno::FromBits, i+1};
+	};
+	for (unsigned i=0; i<100; i++) {
+		dict.insert({numbered(i), std::to_string(i)});
+	}
+	EXPECT_EQ(dict.size(), 102);
+	EXPECT_EQ(dict.at(numbered(42)), "42");
+	dict.erase(numbered(42));
+	EXPECT_FALSE(dict.contains(numbered(42)));
+
+	// Every entry must be found in place, with or without the index.
+	steno::Stroke const two[] = {{"TWO"}};
+	EXPECT_EQ(dict.find(two)->text(), "two");
+	for (auto it=dict.begin(); it!=dict.end(); ++it) {
+		EXPECT_EQ(dict.find(it->phrase()), it);
+	}
+	dict.dropIndex();
+	EXPECT_FALSE(dict.indexed());
+	EXPECT_EQ(dict.find(two)->text(), "two");
+	EXPECT_EQ(dict.find(numbered(7))->text(), "7");
+}
+
+TEST(StenoDictionary, Bounds) {
+	steno::Dictionary const dict {
+		{{"KAT"}, "cat"}, {{"KAT/A"}, "kata"}, {{"KAT/HROG"}, "catalog"},
+		{{"TKOG"}, "dog"},
+	};
+	EXPECT_EQ(dict.lower_bound({"KAT"})->text(), "cat");
+	EXPECT_EQ(dict.upper_bound({"KAT"})->text(), "kata");
+	EXPECT_EQ(dict.lower_bound({"KAT/HROG/-B"})->text(), "dog");
+	EXPECT_EQ(dict.upper_bound({"KAT/HROG/-B"})->text(), "dog");
+	EXPECT_EQ(dict.lower_bound({"TKOG/TKOG"}), dict.end());
+
+	auto [first, last] = dict.equal_range({"KAT/HROG/-B"});
+	EXPECT_EQ(first, last);
+	std::tie(first, last) = dict.equal_range({"TKOG"});
+	EXPECT_EQ(last - first, 1);
+	EXPECT_EQ(first->text(), "dog");
+}
+
+TEST(StenoDictionary, FindMany) {
+	steno::Dictionary dict {};
+	std::vector<steno::Phrase> queries {};
+	for (uint32_t i=1; i<=2000; i++) {
+		steno::Phrase const phrase {{steno::FromBits, i * 37}, {steno::FromBits, i % 7 + 1}};
+		if (i % 3) dict.insert({phrase, std::to_string(i)});
+		queries.push_back(phrase);
+		if (i % 5 == 0) queries.push_back(phrase.front()); // Mostly missing
+	}
+	std::reverse(queries.begin() + 100, queries.end());
+	queries.push_back(queries.front());
+
+	for (bool index : {false, true}) {
+		if (index) dict.buildIndex();
+		std::vector<steno::Dictionary::const_iterator> found (queries.size());
+		std::as_const(dict).findMany(queries, found);
+		for (std::size_t i=0; i<queries.size(); i++) {
+			ASSERT_EQ(found[i], std::as_const(dict).find(queries[i])) << i << index;
+		}
+
+		std::vector<std::span<steno::Stroke const>> spans {queries.begin(), queries.end()};
+		std::fill(found.begin(), found.end(), dict.cend());
+		dict.findMany(spans, found);
+		for (std::size_t i=0; i<queries.size(); i++) {
+			ASSERT_EQ(found[i], std::as_const(dict).find(queries[i])) << i << index;
+		}
+	}
+}
+
+TEST(StenoDictionary, EraseIf) {
+	// Enough entries for several threads, with gaps in every part.
+	std::vector<steno::Brief> entries {};
+	for (uint32_t i=1; i<=50000; i++) {
+		entries.push_back({steno::Phrase {{steno::FromBits, i}}, std::to_string(i % 10)});
+	}
+	steno::Dictionary const dict {entries.begin(), entries.end()};
+	auto const odd = [] (steno::Brief const& b) { return (b.text().back() - '0') % 2; };
+
+	auto serial = dict, parallel = dict;
+	serial.buildIndex();
+	EXPECT_EQ(erase_if(serial, odd), 25000);
+	EXPECT_EQ(parallel.eraseIfParallel(odd, 4), 25000);
+	EXPECT_EQ(serial, parallel);
+	EXPECT_TRUE(std::is_sorted(serial.begin(), serial.end()));
+	for (auto it=serial.begin(); it!=serial.end(); ++it) {
+		ASSERT_EQ(serial.find(it->phrase()), it);
+	}
+	EXPECT_EQ(erase_if(serial, odd), 0);
+	EXPECT_EQ(parallel.eraseIfParallel([] (auto) { return true; }), 25000);
+	EXPECT_TRUE(parallel.empty());
+
+	auto const entry = *serial.begin();
+	EXPECT_EQ(erase(serial, entry), 1);
+	EXPECT_EQ(erase(serial, entry), 0);
+	EXPECT_FALSE(serial.contains(entry.phrase()));
+	EXPECT_EQ(serial.size(), 24999);
+}
+
+TEST(StenoDictionary, Merge) {
+	steno::Dictionary const ours {
+		{{"KAT"}, "cat"}, {{"TKOG"}, "dog"}, {{"TPEURB"}, "fish"},
+	};
+	steno::Dictionary const theirs {
+		{{"A"}, "a"}, {{"KAT"}, "Cat"}, {{"KAT/-S"}, "cats"}, {{"TKOG"}, "Dog"},
+		{{"WUFL"}, "wolf"},
+	};
+	auto a = ours, b = theirs;
+	a.buildIndex();
+	a.merge(b);
+	EXPECT_EQ(b, theirs);
+	EXPECT_EQ(a, (steno::Dictionary {
+		{{"A"}, "a"}, {{"KAT"}, "Cat"}, {{"KAT/-S"}, "cats"}, {{"TKOG"}, "Dog"},
+		{{"TPEURB"}, "fish"}, {{"WUFL"}, "wolf"},
+	}));
+	for (auto it=a.begin(); it!=a.end(); ++it) EXPECT_EQ(a.find(it->phrase()), it);
+
+	// The same as inserting them one at a time.
+	auto inserted = ours;
+	for (auto const& entry : theirs) inserted.insert(entry);
+	EXPECT_EQ(a, inserted);
+
+	a = ours;
+	a.merge(steno::Dictionary {theirs}, steno::KeepOurs);
+	EXPECT_EQ(a.at({"KAT"}), "cat");
+	EXPECT_EQ(a.at({"KAT/-S"}), "cats");
+	EXPECT_EQ(a.size(), 6);
+
+	a = ours, b = theirs;
+	a.merge(std::move(b), [] (steno::Brief const& x, steno::Brief const& y) {
+		return x.text() + "|" + y.text();
+	});
+	EXPECT_TRUE(b.empty());
+	EXPECT_EQ(a.at({"TKOG"}), "dog|Dog");
+	EXPECT_EQ(a.at({"WUFL"}), "wolf");
+
+	a = {};
+	a.merge(b = theirs);
+	EXPECT_EQ(a, theirs);
+	a.merge(a);
+	EXPECT_EQ(a, theirs);
+}
+
+TEST(StenoDictionary, MoveInsertion) {
+	// Too long to be kept inline, so copying either would allocate.
+	auto const longPhrase = [] (uint32_t i) {
+		steno::Phrase result {};
+		for (uint32_t k=1; k<=6; k++) result.push_back({steno::FromBits, i*8 + k});
+		return result;
+	};
+	std::string const padding (40, '-');
+	std::vector<steno::Brief> entries {};
+	for (uint32_t i=0; i<100; i++) entries.emplace_back(longPhrase(i), padding + std::to_string(i));
+	auto phrase = longPhrase(100), same = longPhrase(100);
+	auto text = padding, other = padding;
+
+	steno::Dictionary dict {};
+	dict.reserve(200);
+	auto const before = allocations.load();
+	for (auto& entry : entries) dict.insert(std::move(entry));
+	dict.emplace(std::move(phrase), std::move(text));
+	auto const [it, added] = dict.try_emplace(std::move(same), std::move(other));
+	EXPECT_EQ(allocations - before, 0);
+
+	EXPECT_EQ(dict.size(), 101);
+	EXPECT_FALSE(added);
+	EXPECT_EQ(it->text(), padding);
+	EXPECT_EQ(other, padding); // Left alone, as it wasn't needed
+	EXPECT_EQ(dict.at(longPhrase(42)), padding + "42");
+	EXPECT_TRUE(dict.try_emplace(longPhrase(101), 3, 'x').second);
+	EXPECT_EQ(dict.at(longPhrase(101)), "xxx");
+	EXPECT_EQ(dict.try_emplace(steno::Phrase {"KAT"}, " cat ").first->text(), "cat");
+}
+
 TEST(StenoDictionary, PhraseAccess) {
 	steno::Dictionary dict {{{"KAOE"}, "value"}};
 	steno::Phrase const key {"KAOE"};
@@ -878,8 +1232,8 @@ TEST(StenoDictionary, AssociativeExpressions) {
 		EXPECT_EXPRESSION(std::swap(lhs, rhs), void,
 			EXPECT_EQ(lhs, Value1); EXPECT_EQ(rhs, Value2)
 		);
-		EXPECT_EXPRESSION(erase(a, steno::NoBrief)            , void);
-		EXPECT_EXPRESSION(erase_if(a, [] (auto) { return 1; }), void);
+		EXPECT_EXPRESSION(erase(a, steno::NoBrief)            , X::size_type);
+		EXPECT_EXPRESSION(erase_if(a, [] (auto) { return 1; }), X::size_type);
 	}
 	// Map specific
 	a = b;
@@ -903,3 +1257,613 @@ TEST(StenoParseDictionary, Plain) {
 
 	// TODO
 }
+
+TEST(StenoParseDictionary, JsonBuffer) {
+	std::ifstream file {"./examples/test-dictionaries/elements.json"};
+	std::string const contents {std::istreambuf_iterator<char> {file}, {}};
+	std::istringstream stream {contents};
+	auto const expected = steno::parseDictionary(stream, steno::Json);
+	auto const result = steno::parseDictionary(contents, steno::Json);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(*result, *expected);
+	EXPECT_EQ(steno::parseDictionary(contents), expected);
+
+	// Views point into the buffer, unless there was an escape to undo.
+	std::string_view const escapes = R"({"KWOET": "\"quote\"", "PHRAEUPB": "plain"})";
+	steno::BufferParser<steno::Json> parser {escapes};
+	ASSERT_TRUE(parser.next());
+	EXPECT_EQ(parser.phrase(), "KWOET");
+	EXPECT_EQ(parser.text(), "\"quote\"");
+	ASSERT_TRUE(parser.next());
+	EXPECT_EQ(parser.text(), "plain");
+	EXPECT_EQ(parser.text().data(), escapes.data() + escapes.find("plain"));
+	EXPECT_FALSE(parser.next());
+	EXPECT_FALSE(parser.failed());
+
+	steno::BufferParser<steno::Json> broken {R"({"KWOET" "missing colon"})"};
+	EXPECT_FALSE(broken.next());
+	EXPECT_TRUE(broken.failed());
+}
+
+TEST(StenoParseDictionary, Detection) {
+	using D = steno::Detection;
+	auto const detect = [] (std::string_view prefix) {
+		auto const d = steno::detectFileType(prefix);
+		return std::pair {d.type, d.confidence};
+	};
+	EXPECT_EQ(detect("{\\rtf1\\ansi"), std::pair(steno::Rtf, D::Certain));
+	EXPECT_EQ(detect("\n{\n\t\"KAT\": \"cat\""), std::pair(steno::Json, D::Certain));
+	EXPECT_EQ(detect("{  "), std::pair(steno::Json, D::Likely));
+	EXPECT_EQ(detect("KAT = cat\n"), std::pair(steno::Plain, D::Certain));
+	EXPECT_EQ(detect("KAT = c"), std::pair(steno::Plain, D::Likely));
+	EXPECT_EQ(detect("\xEF\xBB\xBF{}"), std::pair(steno::Json, D::Certain));
+	EXPECT_EQ(steno::detectFileType("\xEF\xBB\xBF{}").skip, 3);
+	EXPECT_EQ(detect("KAT\n= cat"), std::pair(steno::NoFileType, D::None));
+	EXPECT_EQ(detect(""), std::pair(steno::NoFileType, D::None));
+
+	// Every test dictionary is read the same with or without its type.
+	for (auto [path, type] : {
+		std::pair {"./examples/test-dictionaries/states.txt", steno::Plain},
+		{"./examples/test-dictionaries/elements.json", steno::Json},
+		{"./examples/test-dictionaries/languages.rtf", steno::Rtf},
+	}) {
+		std::ifstream typed {path}, untyped {path};
+		steno::Detection detection {};
+		auto const result = steno::parseDictionary(untyped, detection);
+		EXPECT_EQ(detection.type, type);
+		EXPECT_EQ(detection.confidence, D::Certain);
+		EXPECT_TRUE(result);
+		EXPECT_EQ(result, steno::parseDictionary(typed, type));
+	}
+
+	// A byte order mark is skipped, whether from a stream or a buffer.
+	std::string const marked = "\xEF\xBB\xBFKAT = cat\nTKOG = dog\n";
+	std::istringstream stream {marked};
+	auto const result = steno::parseDictionary(stream);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(result->at(steno::Phrase {"KAT"}), "cat");
+	EXPECT_EQ(steno::parseDictionary(marked), result);
+}
+
+TEST(StenoParseDictionary, RtfLastEntry) {
+	std::ifstream file {"./examples/test-dictionaries/languages.rtf"};
+	auto result = steno::parseDictionary(file, steno::Rtf);
+	ASSERT_TRUE(result);
+	EXPECT_EQ(result->at(steno::Phrase {"SKAEL"}), "Scala");
+}
+
+TEST(StenoParseDictionary, Parallel) {
+	// Big enough to be split several ways.
+	std::string plain {}, json {"{\n"}, rtf {"{\\rtf1\\ansi\\cxdict\n"};
+	for (unsigned i=0; i<20000; i++) {
+		steno::Phrase const phrase {{steno::FromBits, i % 1000 + 1}, {steno::FromBits, i * 7 + 1}};
+		auto const key = toString(phrase), text = "entry " + std::to_string(i % 3000);
+		plain += key + " = " + text + "\n";
+		json += "\"" + key + "\": \"" + text + "\",\n";
+		rtf += "{\\*\\cxs " + key + "}" + text + "\n";
+	}
+	json += "\"TKUPL\": \"dummy\"\n}\n";
+	rtf += "}\n";
+
+	for (auto [type, buffer] : {
+		std::pair {steno::Plain, plain}, {steno::Json, json}, {steno::Rtf, rtf}
+	}) {
+		std::istringstream stream {buffer};
+		auto const expected = steno::parseDictionary(stream, type);
+		ASSERT_TRUE(expected);
+		EXPECT_EQ(expected->size(), type == steno::Json? 20001: 20000);
+		EXPECT_EQ(steno::parseDictionary(buffer, type), expected);
+		std::istringstream untyped {buffer};
+		EXPECT_EQ(steno::parseDictionary(untyped), expected);
+		for (unsigned threads : {1, 3, 8}) {
+			EXPECT_EQ(steno::parseDictionaryParallel(buffer, type, threads), expected);
+		}
+	}
+}
+
+TEST(StenoParseDictionary, Allocations) {
+	// Short phrases are kept inline, so each entry needs just its text.
+	std::string json {"{\n"};
+	for (unsigned i=0; i<1000; i++) {
+		steno::Phrase const phrase {{steno::FromBits, i + 1}, {steno::FromBits, i * 7 + 1}};
+		json += "\"" + toString(phrase) + "\": \"some text too long to be inline " + std::to_string(i) + "\",\n";
+	}
+	json += "\"TKUPL\": \"dummy\"\n}\n";
+
+	auto const before = allocations.load();
+	auto const dict = steno::parseDictionary(json, steno::Json);
+	auto const count = allocations - before;
+	ASSERT_TRUE(dict);
+	EXPECT_EQ(dict->size(), 1001);
+	// Only the entry vector's growth on top of that.
+	EXPECT_LE(count, dict->size() + 32);
+
+	// Streams too, with each entry moved from the parser into storage.
+	for (auto type : {steno::Plain, steno::Json, steno::Rtf}) {
+		std::ostringstream output {};
+		ASSERT_TRUE(steno::writeDictionary(output, *dict, type));
+		std::istringstream input {output.str()};
+		auto const before = allocations.load();
+		auto const result = steno::parseDictionary(input, type);
+		auto const count = allocations - before;
+		EXPECT_EQ(result, dict) << type;
+		EXPECT_LE(count, dict->size() + 32) << type;
+	}
+}
+
+TEST(StenoParseDictionary, Write) {
+	steno::Dictionary all {};
+	for (auto path : {
+		"./examples/test-dictionaries/states.txt",
+		"./examples/test-dictionaries/elements.json",
+		"./examples/test-dictionaries/languages.rtf",
+	}) {
+		std::ifstream file {path};
+		all.merge(*steno::parseDictionary(file));
+	}
+	all[steno::Phrase {"KWOET/#-T"}] = R"(say "hi" \ bye)";
+	all[steno::Phrase {"TAB"}] = "a\tb=c {^}";
+
+	// Whatever is written reads back the same, streamed or from a buffer.
+	for (auto type : {steno::Plain, steno::Json, steno::Rtf}) {
+		// RTF text is kept as markup, where a lone backslash can't be.
+		auto expected = all;
+		if (type == steno::Rtf) expected.erase(steno::Phrase {"PWHRA*RB"});
+		std::ostringstream output {};
+		EXPECT_EQ(steno::writeDictionary(output, all, type), type != steno::Rtf);
+		std::istringstream input {output.str()};
+		EXPECT_EQ(steno::parseDictionary(input, type), expected) << type;
+		EXPECT_EQ(steno::parseDictionary(output.str()), expected) << type;
+	}
+
+	std::ostringstream json {};
+	steno::writeDictionary(json, {{steno::Brief {{"KAT"}, "a\nb\tc"}}}, steno::Json);
+	EXPECT_EQ(json.str(), "{\n\"KAT\": \"a\\nb\\tc\"\n}\n");
+
+	// Entries the format can't hold are left out, and reported.
+	steno::Dictionary const awkward {
+		{{"KAT"}, "cat"}, {{"TKOG"}, "line\nbreak"}, {{"TPHOUS"}, "open {group"},
+	};
+	for (auto type : {steno::Plain, steno::Rtf}) {
+		std::ostringstream output {};
+		EXPECT_FALSE(steno::writeDictionary(output, awkward, type));
+		std::istringstream input {output.str()};
+		auto const result = steno::parseDictionary(input, type);
+		ASSERT_TRUE(result);
+		EXPECT_EQ(result->size(), 2);
+		EXPECT_EQ(result->at(steno::Phrase {"KAT"}), "cat");
+	}
+	// JSON only has escapes the readers undo for some control characters.
+	std::ostringstream bell {};
+	EXPECT_FALSE(steno::writeDictionary(bell, {{{"KAT"}, "cat"}, {{"PWEL"}, "ring\a"}}, steno::Json));
+	EXPECT_EQ(bell.str(), "{\n\"KAT\": \"cat\"\n}\n");
+}
+
+/* ~~ Translator Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "steno_translator.hh"
+
+TEST(StenoTranslator, LongestMatch) {
+	steno::Dictionary dict {
+		{{"KAT"}, "cat"},
+		{{"A"}, "a"},
+		{{"KAT/A"}, "kata"},
+		{{"KAT/A/HRO*G"}, "catalogue"},
+		{{"HRO*G"}, "log"},
+	};
+	dict.buildIndex();
+	steno::Translator translator {dict};
+	EXPECT_EQ(translator.lookahead(), 3);
+
+	std::string output {};
+	auto stroke = [&] (steno::Stroke s) {
+		auto [erase, text] = translator.translate(s);
+		output.erase(output.size() - erase);
+		output += text;
+		return output;
+	};
+	EXPECT_EQ(stroke({"KAT"}), " cat");
+	EXPECT_EQ(stroke({"A"}), " kata");
+	EXPECT_EQ(stroke({"HRO*G"}), " catalogue");
+	EXPECT_EQ(stroke({"HRO*G"}), " catalogue log");
+	EXPECT_EQ(stroke({"TKOG"}), " catalogue log TKOG");
+	// Undo restores whatever the removed translation had joined.
+	EXPECT_EQ(stroke({"*"}), " catalogue log");
+	EXPECT_EQ(stroke({"*"}), " catalogue");
+	EXPECT_EQ(stroke({"*"}), " kata");
+	// Carrying on after an undo picks up where it left off.
+	EXPECT_EQ(stroke({"HRO*G"}), " catalogue");
+	EXPECT_EQ(stroke({"*"}), " kata");
+	EXPECT_EQ(stroke({"*"}), " cat");
+	EXPECT_EQ(stroke({"*"}), "");
+	EXPECT_EQ(stroke({"*"}), "");
+}
+
+TEST(StenoTranslator, PrefixTrie) {
+	steno::Dictionary const dict {
+		{{"KAT"}, "cat"}, {{"KAT/A"}, "kata"}, {{"KAT/A/HRO*G"}, "catalogue"},
+		{{"KAT/HROG"}, "catalog"}, {{"TKOG"}, "dog"}, {{"A/HRO*G"}, "a log"},
+	};
+	steno::PrefixTrie const trie {dict};
+	EXPECT_EQ(trie.depth(), 3);
+
+	steno::Phrase const kat {"KAT"};
+	auto const completions = trie.completions(kat);
+	ASSERT_EQ(completions.size(), 4);
+	for (auto const& entry : completions) EXPECT_EQ(entry.phrase()[0], kat[0]);
+	EXPECT_TRUE(trie.hasLongerEntries(kat));
+	EXPECT_FALSE(trie.hasLongerEntries(steno::Phrase {"TKOG"}));
+	EXPECT_FALSE(trie.hasLongerEntries(steno::Phrase {"TKOG/TKOG"}));
+	EXPECT_TRUE(trie.completions(steno::Phrase {"KAT/KAT"}).empty());
+
+	// Walking one stroke at a time, finding entries along the way.
+	auto cursor = trie.child(steno::PrefixTrie::Root, {"A"});
+	EXPECT_EQ(trie.entry(cursor), nullptr);
+	EXPECT_TRUE(trie.hasLongerEntries(cursor));
+	cursor = trie.child(cursor, {"HRO*G"});
+	ASSERT_NE(trie.entry(cursor), nullptr);
+	EXPECT_EQ(trie.entry(cursor)->text(), "a log");
+	cursor = trie.child(cursor, {"HRO*G"});
+	EXPECT_EQ(cursor, steno::PrefixTrie::NoCursor);
+	EXPECT_EQ(trie.entry(cursor), nullptr);
+	EXPECT_TRUE(trie.completions(cursor).empty());
+
+	// The number bar is the top bit, and few keys leave it at the root.
+	steno::Dictionary const numberDict {
+		{{"KAT"}, "cat"}, {{"#KAT"}, "number cat"}, {{"1/2"}, "one two"},
+	};
+	steno::PrefixTrie const numbers {numberDict};
+	cursor = numbers.child(steno::PrefixTrie::Root, {"#KAT"});
+	ASSERT_NE(numbers.entry(cursor), nullptr);
+	EXPECT_EQ(numbers.entry(cursor)->text(), "number cat");
+	steno::Phrase const oneTwo {"1/2"};
+	EXPECT_EQ(numbers.child(numbers.child(steno::PrefixTrie::Root, {"1"}), {"2"}), numbers.find(oneTwo));
+	EXPECT_EQ(numbers.completions(steno::Phrase {"KAT"}).size(), 1);
+	steno::Dictionary const one {{{"1"}, "one"}};
+	steno::Translator translator {one};
+	EXPECT_EQ(translator.translate({"1"}).text, " one");
+}
+
+/* ~~ Binary Dictionary Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "steno_binary.hh"
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+
+TEST(StenoBinary, RoundTrip) {
+	std::ifstream file {"./examples/test-dictionaries/states.txt"};
+	auto const dict = steno::parseDictionary(file, steno::Plain);
+	ASSERT_TRUE(dict);
+	char const* path = "test-binary.dict";
+
+	for (bool index : {true, false}) {
+		{
+			std::ofstream output {path, std::ios::binary};
+			EXPECT_TRUE(steno::writeBinary(output, *dict, index));
+		}
+		auto const mapped = steno::MappedDictionary::open(path);
+		ASSERT_TRUE(mapped);
+		EXPECT_EQ(mapped->indexed(), index);
+		EXPECT_EQ(mapped->size(), dict->size());
+		EXPECT_EQ(mapped->toDictionary(), *dict);
+		for (auto const& entry : *dict) {
+			EXPECT_EQ(mapped->at(entry.phrase()), entry.text());
+		}
+		steno::Stroke const missing[] = {{"TPHOPB"}, {"-G"}};
+		EXPECT_FALSE(mapped->contains(missing));
+		EXPECT_THROW(mapped->at(missing), std::out_of_range);
+
+		// Moving the mapping leaves an empty dictionary behind.
+		auto from = steno::MappedDictionary::open(path);
+		ASSERT_TRUE(from);
+		auto const to = std::move(*from);
+		EXPECT_EQ(to.size(), dict->size());
+		EXPECT_EQ(from->size(), 0);
+		EXPECT_TRUE(from->empty());
+		EXPECT_FALSE(from->indexed());
+		EXPECT_EQ(from->begin(), from->end());
+		EXPECT_FALSE(from->contains(dict->begin()->phrase()));
+		EXPECT_EQ(from->toDictionary(), steno::Dictionary {});
+	}
+
+	// Anything cut short, or not in the format at all, is turned away.
+	{
+		std::ofstream output {path, std::ios::binary};
+		EXPECT_TRUE(steno::writeBinary(output, *dict));
+	}
+	std::ifstream whole {path, std::ios::binary};
+	std::string contents {std::istreambuf_iterator<char> {whole}, {}};
+	std::ofstream {path, std::ios::binary} << contents.substr(0, contents.size() / 2);
+	EXPECT_FALSE(steno::MappedDictionary::open(path));
+
+	// So is an index with no empty slot, where a search might never end.
+	steno::BinaryHeader header {};
+	std::memcpy(&header, contents.data(), sizeof header);
+	auto packed = contents;
+	uint64_t slot {};
+	for (uint32_t i=0; i<header.indexSize && !slot; i++) {
+		std::memcpy(&slot, contents.data() + header.index + i*8, 8);
+	}
+	for (uint32_t i=0; i<header.indexSize; i++) {
+		std::memcpy(packed.data() + header.index + i*8, &slot, 8);
+	}
+	std::ofstream {path, std::ios::binary} << packed;
+	EXPECT_FALSE(steno::MappedDictionary::open(path));
+	auto small = contents;
+	uint32_t const one = 1;
+	std::memcpy(small.data() + offsetof(steno::BinaryHeader, indexSize), &one, sizeof one);
+	std::ofstream {path, std::ios::binary} << small;
+	EXPECT_FALSE(steno::MappedDictionary::open(path));
+
+	std::ofstream {path, std::ios::binary} << "not a dictionary, just some text";
+	EXPECT_FALSE(steno::MappedDictionary::open(path));
+	std::remove(path);
+	EXPECT_FALSE(steno::MappedDictionary::open(path));
+}
+
+/* ~~ Dictionary Stack Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "steno_stack.hh"
+
+TEST(StenoStack, Priority) {
+	steno::DictionaryStack stack {
+		{{{"KAT"}, "cat"}, {{"TKOG"}, "dog"}},
+		{{{"KAT"}, "Cat"}},
+	};
+	auto const text = [&] (char const* strokes) -> std::string {
+		auto const* entry = stack.find(steno::Phrase {strokes});
+		return entry? entry->text(): "-";
+	};
+	EXPECT_EQ(text("KAT"), "Cat");
+	EXPECT_EQ(text("TKOG"), "dog");
+	EXPECT_EQ(text("PWEUFRD"), "-");
+	EXPECT_EQ(stack.layerOf(steno::Phrase {"TKOG"}), 0);
+
+	// Results looked up before a change never outlive it.
+	stack.disable(1);
+	EXPECT_EQ(text("KAT"), "cat");
+	stack.enable(1);
+	EXPECT_EQ(text("KAT"), "Cat");
+	stack.edit(1)[steno::Phrase {"PWEUFRD"}] = "bird";
+	EXPECT_EQ(text("PWEUFRD"), "bird");
+	stack.edit(0).erase(steno::Phrase {"TKOG"});
+	EXPECT_EQ(text("TKOG"), "-");
+	auto const user = stack.push({{{"TKOG"}, "Dog"}});
+	EXPECT_EQ(text("TKOG"), "Dog");
+	EXPECT_EQ(stack.layerOf(steno::Phrase {"TKOG"}), user);
+	stack.edit(user).clear();
+	EXPECT_EQ(text("TKOG"), "-");
+	EXPECT_EQ(stack.layerOf(steno::Phrase {"TKOG"}), steno::DictionaryStack::NoLayer);
+
+	steno::Dictionary const flat {{{"KAT"}, "Cat"}, {{"PWEUFRD"}, "bird"}};
+	EXPECT_EQ(stack.flatten(), flat);
+}
+
+TEST(StenoStack, EntryEdits) {
+	steno::DictionaryStack stack {{{{"KAT"}, "cat"}, {{"TKOG"}, "dog"}}, {}};
+	auto const text = [&] (char const* strokes) -> std::string {
+		auto const* entry = stack.find(steno::Phrase {strokes});
+		return entry? entry->text(): "-";
+	};
+	EXPECT_EQ(text("KAT"), "cat");
+	EXPECT_EQ(text("PWEUFRD"), "-");
+
+	stack.insert(1, {{"KAT"}, "Cat"});
+	EXPECT_EQ(text("KAT"), "Cat");
+	EXPECT_EQ(text("TKOG"), "dog");
+	// Entries found in a layer are looked up again once it grows.
+	for (uint32_t i=1; i<=1000; i++) {
+		stack.insert(1, {steno::Phrase {steno::Stroke {steno::FromBits, i}}, "x"});
+		EXPECT_EQ(text("KAT"), "Cat");
+	}
+	stack.insert(1, {{"KAT"}, "CAT"});
+	EXPECT_EQ(text("KAT"), "CAT");
+	stack.insert(0, {{"KAT"}, "kitten"});
+	EXPECT_EQ(text("KAT"), "CAT");
+	stack.erase(1, steno::Phrase {"KAT"});
+	EXPECT_EQ(text("KAT"), "kitten");
+	stack.erase(1, steno::Phrase {"KAT"});
+	stack.erase(0, steno::Phrase {"KAT"});
+	EXPECT_EQ(text("KAT"), "-");
+	stack.insert(0, {{"PWEUFRD"}, "bird"});
+	EXPECT_EQ(text("PWEUFRD"), "bird");
+	EXPECT_EQ(stack.layerOf(steno::Phrase {"TKOG"}), 0);
+	EXPECT_EQ(stack.layer(1).size(), 1000);
+}
+
+/* ~~ Shared Dictionary Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "steno_shared.hh"
+#include <thread>
+
+TEST(StenoShared, Snapshots) {
+	steno::SharedDictionary shared {{{{"KAT"}, "cat"}, {{"TKOG"}, "dog"}}};
+	auto const before = shared.snapshot();
+	shared.insert({{"PWEUFRD"}, "bird"});
+	shared.erase(steno::Phrase {"KAT"});
+	shared.erase(steno::Phrase {"TPEURB"});
+
+	// A snapshot never changes, whatever is done after it was taken.
+	EXPECT_EQ(before.size(), 2);
+	EXPECT_TRUE(before.contains(steno::Phrase {"KAT"}));
+	EXPECT_FALSE(before.contains(steno::Phrase {"PWEUFRD"}));
+	auto const after = shared.snapshot();
+	EXPECT_EQ(after.size(), 2);
+	EXPECT_FALSE(after.contains(steno::Phrase {"KAT"}));
+	EXPECT_EQ(after.find(steno::Phrase {"PWEUFRD"})->text(), "bird");
+	steno::Dictionary const expected {{{"TKOG"}, "dog"}, {{"PWEUFRD"}, "bird"}};
+	EXPECT_EQ(after.toDictionary(), expected);
+
+	// Past the overlay's limit, everything is folded into a new base.
+	steno::Dictionary reference = after.toDictionary();
+	for (uint32_t i=1; i<=4000; i++) {
+		steno::Phrase const phrase {steno::Stroke {steno::FromBits, i % 2000 + 1}};
+		if (i % 3 == 0) {
+			shared.erase(phrase);
+			reference.erase(phrase);
+		}
+		else {
+			shared.insert({phrase, std::to_string(i)});
+			reference[phrase] = std::to_string(i);
+		}
+	}
+	EXPECT_EQ(shared.snapshot().size(), reference.size());
+	EXPECT_EQ(shared.snapshot().toDictionary(), reference);
+
+	// Copies and moves keep the version they were taken from.
+	auto copy = before;
+	auto moved = std::move(copy);
+	copy = after;
+	shared.erase(steno::Phrase {"TKOG"});
+	EXPECT_TRUE(moved.contains(steno::Phrase {"KAT"}));
+	EXPECT_EQ(copy.find(steno::Phrase {"TKOG"})->text(), "dog");
+	EXPECT_FALSE(shared.snapshot().contains(steno::Phrase {"TKOG"}));
+}
+
+TEST(StenoShared, ConcurrentReaders) {
+	steno::SharedDictionary shared {};
+	std::atomic<bool> done = false;
+	std::atomic<std::size_t> torn = 0;
+	std::vector<std::jthread> readers {};
+	for (int i=0; i<3; i++) readers.emplace_back([&] {
+		while (!done) {
+			// Each batch writes a pair of entries, so both or neither show.
+			auto const snapshot = shared.snapshot();
+			torn += snapshot.contains(steno::Phrase {"KAT"})
+			!=      snapshot.contains(steno::Phrase {"TKOG"});
+		}
+	});
+	for (int i=0; i<2000; i++) {
+		using Edit = steno::SharedDictionary::Edit;
+		auto const text = i % 2? std::optional<steno::Text> {"x"}: std::nullopt;
+		Edit const edits[] = {{steno::Phrase {"KAT"}, text}, {steno::Phrase {"TKOG"}, text}};
+		shared.apply(edits);
+	}
+	done = true;
+	readers.clear();
+	EXPECT_EQ(torn, 0);
+	EXPECT_EQ(shared.snapshot().size(), 2);
+}
+
+/* ~~ Reverse Index Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "steno_reverse.hh"
+
+TEST(StenoReverse, Ranking) {
+	steno::Dictionary const dict {
+		{{"KA/-T"}, "cat"}, {{"KA*T"}, "cat"}, {{"KAUT"}, "cat"}, {{"KAT"}, "cat"},
+		{{"TKOG"}, "dog"}, {{"TKAG"}, "dog"}, {{"PWEUFRD"}, "bird"},
+	};
+	steno::ReverseIndex const index {dict};
+	auto const phrases = [&] (std::string_view text) {
+		std::vector<std::string> result {};
+		for (auto const* entry : index.find(text)) result.push_back(toString(entry->phrase()));
+		return result;
+	};
+	EXPECT_EQ(index.size(), 3);
+	// Fewest strokes, then keys, then asterisks, then dictionary order.
+	EXPECT_EQ(phrases("cat"), (std::vector<std::string> {"KAT", "KAUT", "KA*T", "KA/-T"}));
+	EXPECT_EQ(phrases("dog"), (std::vector<std::string> {"TKOG", "TKAG"}));
+	EXPECT_EQ(index.best("bird")->phrase(), steno::Phrase {"PWEUFRD"});
+	EXPECT_EQ(index.best("fish"), nullptr);
+	EXPECT_FALSE(index.contains("Cat"));
+	EXPECT_FALSE(index.contains(""));
+	EXPECT_FALSE(steno::ReverseIndex {}.contains("cat"));
+}
+
+TEST(StenoReverse, Translator) {
+	steno::Dictionary const dict {
+		{{"TPH"}, "in"}, {{"-T"}, "the"}, {{"TPH-T"}, "in the"},
+		{{"AZ"}, "as"}, {{"WEL"}, "well"}, {{"AZ/WEL"}, "as well"}, {{"SWELZ"}, "as well as"},
+		{{"AEUB"}, "a b"}, {{"PWEUD"}, "b c d"}, {{"AEU"}, "a"}, {{"TKE"}, "d"},
+	};
+	steno::ReverseTranslator translator {dict};
+	EXPECT_EQ(translator.lookahead(), 3);
+	std::size_t early = 0;
+	auto const translate = [&] (std::vector<std::string_view> tokens) {
+		std::vector<std::string> result {};
+		auto const add = [&] (auto segments) {
+			for (auto const& s : segments) {
+				result.push_back(s.entry? toString(s.entry->phrase()): '(' + std::string {s.text} + ')');
+			}
+		};
+		for (auto token : tokens) add(translator.push(token));
+		early = result.size();
+		add(translator.finish());
+		return result;
+	};
+	using Strings = std::vector<std::string>;
+	EXPECT_EQ(translate({"in", "the", "house", "as", "well", "as", "the", "{.}"}),
+		(Strings {"TPH-T", "(house)", "SWELZ", "-T", "({.})"}));
+	// Settled as it went, rather than all at the end.
+	EXPECT_GE(early, 2);
+	// The longest first match isn't always the fewest strokes.
+	EXPECT_EQ(translate({"a", "b", "c", "d"}), (Strings {"AEU", "PWEUD"}));
+	EXPECT_EQ(translate({"as", "well"}), (Strings {"AZ/WEL"}));
+	EXPECT_EQ(translate({}), Strings {});
+
+	// Settling early still covers every token.
+	translator.pendingLimit = 1;
+	EXPECT_EQ(translate({"a", "b", "c", "d"}), (Strings {"AEU", "(b)", "(c)", "TKE"}));
+}
+
+TEST(StenoReverse, Tokenizer) {
+	auto const tokenize = [] (std::string const& text) {
+		std::istringstream input {text};
+		steno::TextTokenizer tokenizer {input};
+		std::vector<std::string> result {};
+		while (auto const token = tokenizer.next()) result.emplace_back(*token);
+		return result;
+	};
+	using Strings = std::vector<std::string>;
+	EXPECT_EQ(tokenize("The cat's hat, isn't it? It is."), (Strings {
+		"the", "cat's", "hat", "{,}", "isn't", "it", "{?}", "it", "is", "{.}"
+	}));
+	// Curly quotes, dashes and other letters.
+	EXPECT_EQ(tokenize("‘Don’t’—naïve Café!"), (Strings {
+		"{‘}", "don't", "{’}", "{—}", "naïve", "Café", "{!}"
+	}));
+	EXPECT_EQ(tokenize(" \n\t"), Strings {});
+	EXPECT_EQ(tokenize("\xFF" "a"), (Strings {"{\xFF}", "a"}));
+
+	// Tokens cut across by where the input is read in blocks.
+	std::string book {};
+	for (int i=0; i<20'000; i++) book += "don’t ";
+	auto const tokens = tokenize(book);
+	EXPECT_EQ(tokens.size(), 20'000);
+	EXPECT_EQ(std::count(tokens.begin(), tokens.end(), "don't"), 20'000);
+}
+
+/* ~~ Synthetic Dictionary Tests ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "synthetic.hh"
+
+TEST(StenoSynthetic, Reproducible) {
+	synthetic::Options options {};
+	options.size = 5000;
+	auto const dict = synthetic::generate(options);
+	EXPECT_EQ(dict.size(), 5000);
+	EXPECT_EQ(synthetic::generate(options), dict);
+	options.seed = 2;
+	EXPECT_NE(synthetic::generate(options), dict);
+
+	// Stops when the options allow fewer phrases than asked for.
+	synthetic::Options narrow {};
+	narrow.size = 2;
+	narrow.phraseLengths = {1};
+	narrow.keyFrequencies.fill(0);
+	narrow.keyFrequencies[1] = 0.5;
+	EXPECT_EQ(synthetic::generate(narrow).size(), 1);
+
+	// Known values, so a change to the generator doesn't go unnoticed.
+	synthetic::Random random {1};
+	EXPECT_EQ(random.next(), 0x910A2DEC89025CC1);
+	EXPECT_EQ(random.next(), 0xBEEB8DA1658EEC67);
+
+	for (auto type : {steno::Plain, steno::Json, steno::Rtf}) {
+		std::stringstream file {};
+		EXPECT_TRUE(steno::writeDictionary(file, dict, type));
+		EXPECT_EQ(steno::parseDictionary(file, type), dict);
+	}
+}
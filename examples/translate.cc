@@ -0,0 +1,31 @@
+#include "steno.hh"
+#include "steno_parsers.hh"
+#include "steno_translator.hh"
+#include <iostream>
+#include <fstream>
+#include <string>
+
+// Reads one stroke per line and prints the translated text so far.
+int main(int argc, char const* argv[]) {
+	std::vector<std::string> paths {argv+1, argv+argc};
+	if (paths.empty()) std::cerr << "No dictionaries provided.\n";
+	steno::Dictionary dict {};
+	for (auto path : paths) {
+		if (std::ifstream file {path}) {
+			if (auto result = steno::parseDictionary(file)) dict.merge(*result);
+			else std::cerr << "Unable to parse dictionary " << path << ".\n";
+		}
+		else std::cerr << "Unable to open dictionary " << path << ".\n";
+	}
+
+	steno::Translator translator {dict};
+	std::string output {};
+	for (std::string line; std::getline(std::cin, line);) {
+		steno::Stroke const stroke {line};
+		if (stroke.failed()) { std::cerr << line << "\tREJECT!\n"; continue; }
+		auto const [erase, text] = translator.translate(stroke);
+		output.erase(output.size() - erase);
+		output += text;
+		std::cout << "|" << output << "|\n";
+	}
+}
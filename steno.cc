@@ -1,5 +1,7 @@
 #include "steno.hh"
 #include <cassert>
+#include <array>
+#include <cstring>
 
 namespace /*detail*/ {
 	constexpr auto FailBit   = 0b00000000000000000000000'000000001;
@@ -161,6 +163,110 @@ void Stroke::failConstruction(std::string_view str) {
 	m_bits |= FailBit;
 }
 
+// Bulk parsing
+namespace /*detail*/ {
+	// Stroke(std::string_view) as a table: for each state of its switch
+	// and each kind of character, the keys to add and the state to go to.
+	// The Numeric check only matters to what follows the vowels, so there
+	// is a copy of the table for either answer.
+	struct KeyChars { Key key; char cKey, cNum; };
+	constexpr KeyChars StateKeys[] = {
+		{Key::Num,'#','#'},
+		{Key::S_, 'S','1'}, {Key::T_, 'T','2'}, {Key::K_, 'K'}, {Key::P_, 'P','3'},
+		{Key::W_, 'W'}, {Key::H_, 'H','4'}, {Key::R_, 'R'},
+		{Key::A , 'A','5'}, {Key::O , 'O','0'}, {Key::x , '*'},
+		{Key::E , 'E'}, {Key::U , 'U'},
+		{Key::_F, 'F','6'}, {Key::_R, 'R'}, {Key::_P, 'P','7'}, {Key::_B, 'B'},
+		{Key::_L, 'L','8'}, {Key::_G, 'G'}, {Key::_T, 'T','9'}, {Key::_S, 'S'},
+		{Key::_D, 'D'}, {Key::_Z, 'Z'},
+	};
+	constexpr unsigned StateCount = std::size(StateKeys) + 1; // With End
+	constexpr unsigned VowelA = 8, VowelO = 9, RightF = 13;
+
+	// Any character not listed here behaves just like 'q' does.
+	constexpr std::string_view Significant {"#STKPWHRAO*EUFBLGDZ-0123456789\0", 31};
+	constexpr unsigned ClassCount = Significant.size() + 1;
+	constexpr uint8_t Whitespace = 0xFF;
+
+	constexpr auto CharClass = [] {
+		std::array<uint8_t, 256> result {};
+		for (unsigned i=0; i<Significant.size(); i++) {
+			result[(unsigned char)Significant[i]] = i+1;
+		}
+		result[' '] = result['\t'] = Whitespace;
+		return result;
+	}();
+
+	constexpr auto NumericChar = [] {
+		std::array<bool, 256> result {};
+		for (char c : std::string_view {" \t" "#0123456789"}) result[(unsigned char)c] = true;
+		return result;
+	}();
+
+	// Each entry holds the keys to add, and the next state in the low bits
+	// where the flags would go. Failure is marked by FailBit alone.
+	constexpr uint32_t transition(bool numeric, unsigned state, char c) {
+		constexpr std::string_view Middle {"O*EU" "0"};
+		for (unsigned t=state; t<std::size(StateKeys); t++) {
+			if (t == VowelO && state <= VowelA) {
+				if (c == '-') return RightF << 1;
+				if (!numeric && Middle.find(c) == Middle.npos) return FailBit;
+			}
+			auto const [key, cKey, cNum] = StateKeys[t];
+			if (c != cKey && c != cNum) continue;
+			uint32_t bits = (c == cKey)? (uint32_t)key: 0;
+			if (c == cNum) bits |= (uint32_t)key | (uint32_t)Key::Num;
+			return bits | (t+1) << 1;
+		}
+		return FailBit;
+	}
+
+	constexpr auto Transitions = [] {
+		std::array<uint32_t, 2 * StateCount * ClassCount> result {};
+		for (bool numeric : {false, true})
+		for (unsigned state=0; state<StateCount; state++)
+		for (unsigned k=0; k<ClassCount; k++) {
+			char const c = (k == 0)? 'q': Significant[k-1];
+			result[(numeric*StateCount + state)*ClassCount + k] = transition(numeric, state, c);
+		}
+		return result;
+	}();
+
+	uint32_t parseStrokeBits(std::string_view str) {
+		bool numeric = true;
+		for (char c : str) numeric &= NumericChar[(unsigned char)c];
+		auto const* table = Transitions.data() + numeric*StateCount*ClassCount;
+
+		uint32_t bits = 0, state = 0;
+		bool valid = false;
+		for (char c : str) {
+			auto const k = CharClass[(unsigned char)c];
+			if (k == Whitespace) continue;
+			auto const entry = table[state*ClassCount + k];
+			valid = !(entry & FailBit);
+			if (!valid) break;
+			bits |= entry & ~FlagsMask;
+			state = (entry & FlagsMask) >> 1;
+		}
+		return valid? bits: bits | FailBit;
+	}
+}
+
+void parseStrokes(std::span<std::string_view const> in, std::span<Stroke> out) {
+	assert(in.size() <= out.size());
+	for (std::size_t i=0; i<in.size(); i++) out[i].m_bits = parseStrokeBits(in[i]);
+}
+
+std::size_t parseStrokes(std::string_view str, std::span<Stroke> out, char delimiter) {
+	std::size_t count = 0;
+	for (std::size_t i=0; /**/; count++) {
+		auto const j = std::min(str.find(delimiter, i), str.size());
+		if (count < out.size()) out[count].m_bits = parseStrokeBits(str.substr(i, j-i));
+		if (j == str.size()) return count+1;
+		i = j+1;
+	}
+}
+
 // Key promotion
 Stroke operator~(Key k) {
 	return ~Stroke {k};
@@ -184,6 +290,38 @@ Stroke operator^(Key lhs, Key rhs) {
 
 /* ~~ Phrase Class ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+// Default construction/assignment
+Phrase::Phrase(Phrase const& other) {
+	insert(end(), other.begin(), other.end());
+}
+
+Phrase::Phrase(Phrase&& other) noexcept {
+	*this = std::move(other);
+}
+
+Phrase& Phrase::operator=(Phrase const& other) {
+	if (&other != this) assign(other.begin(), other.end());
+	return *this;
+}
+
+Phrase& Phrase::operator=(Phrase&& other) noexcept {
+	if (&other == this) return *this;
+	if (!local()) ::operator delete(m_storage.heap);
+	if (other.local()) {
+		std::copy_n(other.m_storage.local, other.m_size, m_storage.local);
+	}
+	else m_storage.heap = other.m_storage.heap;
+	m_size = other.m_size;
+	m_capacity = other.m_capacity;
+	other.m_size = 0;
+	other.m_capacity = InlineCount;
+	return *this;
+}
+
+Phrase::~Phrase() {
+	if (!local()) ::operator delete(m_storage.heap);
+}
+
 // Class constructors
 Phrase::Phrase(std::string_view str) {
 	// How to spell the empty phrase (\s*-\s*)
@@ -191,13 +329,9 @@ Phrase::Phrase(std::string_view str) {
 	if (auto j = str.find_last_not_of(" \t"); j != str.npos)
 	if (i == j && str.find('-') != str.npos) return;
 	// Split up strokes by "/" otherwise
-	auto push = [&](auto i, auto j) { emplace_back(str.substr(i, j-i)); };
-	int i=0, j=0;
-	while (j=str.find('/', i), j!=str.npos) {
-		push(i, j);
-		i = j+1;
-	}
-	push(i, str.size());
+	std::size_t const count = std::count(str.begin(), str.end(), '/') + 1;
+	reserve(count);
+	m_size = parseStrokes(str, {data(), count}, '/');
 }
 
 Phrase::Phrase(Stroke x) {
@@ -220,16 +354,77 @@ Phrase::operator bool() const {
 	return !empty() && !failed();
 }
 
+// Comparison
+bool Phrase::operator==(Phrase const& other) const {
+	return std::equal(begin(), end(), other.begin(), other.end());
+}
+
+std::strong_ordering Phrase::operator<=>(Phrase const& other) const {
+	return std::lexicographical_compare_three_way(
+		begin(), end(), other.begin(), other.end()
+	);
+}
+
 // Concatenation
-Phrase& Phrase::operator|=(Phrase p) {
+Phrase& Phrase::operator|=(Phrase const& p) {
 	insert(end(), p.begin(), p.end());
 	return *this;
 }
 
+Phrase& Phrase::operator|=(Phrase&& p) {
+	if (empty() && p.size() > capacity()) return *this = std::move(p);
+	return *this |= std::as_const(p);
+}
+
 Phrase operator|(Phrase lhs, Phrase const& rhs) {
 	lhs |= rhs; return lhs;
 }
 
+// Sequence methods
+Phrase::iterator Phrase::erase(const_iterator p) {
+	return erase(p, p+1);
+}
+
+Phrase::iterator Phrase::erase(const_iterator first, const_iterator last) {
+	auto const i = first - cbegin(), j = last - cbegin();
+	std::copy(begin() + j, end(), begin() + i);
+	m_size -= j - i;
+	return begin() + i;
+}
+
+// Vector methods
+Stroke& Phrase::at(std::size_t n) {
+	if (n >= size()) throw std::out_of_range {"Phrase::at"};
+	return data()[n];
+}
+
+Stroke const& Phrase::at(std::size_t n) const {
+	if (n >= size()) throw std::out_of_range {"Phrase::at"};
+	return data()[n];
+}
+
+// Internal
+void Phrase::grow(std::size_t capacity) {
+	static_assert(std::is_trivially_copyable_v<Stroke>);
+	auto const bytes = capacity * sizeof (Stroke);
+	auto* heap = static_cast<Stroke*>(::operator new(bytes));
+	std::uninitialized_copy(begin(), end(), heap);
+	if (!local()) ::operator delete(m_storage.heap);
+	m_storage.heap = heap;
+	m_capacity = capacity;
+}
+
+// Opens a gap of 'n' strokes at 'p', returns the start of the gap.
+Phrase::iterator Phrase::makeRoom(const_iterator p, std::size_t n) {
+	auto const i = p - cbegin();
+	if (m_size + n > m_capacity) {
+		grow(std::max<std::size_t>(m_size + n, 2*m_capacity));
+	}
+	std::copy_backward(begin() + i, end(), end() + n);
+	m_size += n;
+	return begin() + i;
+}
+
 // Stroke promotion
 Phrase operator|(Stroke lhs, Stroke const& rhs) {
 	return Phrase {lhs, rhs};
@@ -238,8 +433,8 @@ Phrase operator|(Stroke lhs, Stroke const& rhs) {
 /* ~~ Brief Class ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 // Class constructors
-Brief::Brief(Phrase const& p, std::string_view s)
-: m_phrase{p}, m_text{s} { normalize(); }
+Brief::Brief(Phrase p, std::string_view s)
+: m_phrase{std::move(p)}, m_text{s} { normalize(); }
 
 Brief::Brief(Brief const& b, std::string_view s)
 : m_phrase{b.m_phrase}, m_text{s} { normalize(); }
@@ -280,8 +475,9 @@ Brief& Brief::clear() {
 
 // Concatenation
 Brief& Brief::operator|=(Brief other) {
-	m_phrase |= other.m_phrase;
-	m_text += other.m_text;
+	m_phrase |= std::move(other.m_phrase);
+	if (m_text.empty()) m_text = std::move(other.m_text);
+	else m_text += other.m_text;
 	return *this;
 }
 
@@ -310,11 +506,12 @@ Brief& Brief::normalize() {
 		std::remove(m_phrase.begin(), m_phrase.end(), NoStroke),
 		m_phrase.end()
 	);
-	// Remove leading or trailing whitespace.
+	// Remove leading or trailing whitespace, in place.
 	constexpr std::string_view Whitespace {" \t\n\r"};
 	auto i = m_text.find_first_not_of(Whitespace);
 	auto j = m_text.find_last_not_of(Whitespace);
-	m_text = (i != m_text.npos)? m_text.substr(i, j-i + 1): "";
+	if (i == m_text.npos) m_text.clear();
+	else m_text.erase(j+1).erase(0, i);
 	return *this;
 }
 
@@ -335,6 +532,31 @@ namespace /*detail*/ {
 			return a.phrase() < b.phrase();
 		}
 	} EntryCompare {};
+
+	using Strokes = std::span<Stroke const>;
+
+	Strokes strokesOf(Phrase const& p) {
+		return Strokes {p.begin(), p.end()};
+	}
+
+	bool samePhrase(Phrase const& p, Strokes s) {
+		return std::equal(p.begin(), p.end(), s.begin(), s.end());
+	}
+
+	constexpr struct {
+		bool operator()(Brief const& a, Strokes b) const {
+			return std::lexicographical_compare(
+				a.phrase().begin(), a.phrase().end(), b.begin(), b.end()
+			);
+		}
+		bool operator()(Strokes a, Brief const& b) const {
+			return std::lexicographical_compare(
+				a.begin(), a.end(), b.phrase().begin(), b.phrase().end()
+			);
+		}
+	} KeyCompare {};
+
+	using namespace hashIndex;
 }
 
 Dictionary::Dictionary(std::span<Brief const> span) {
@@ -351,6 +573,24 @@ void Dictionary::clean() {
 		||     b.phrase() == NoPhrase
 		||     b.text() == NoText;
 	});
+	reindex();
+}
+
+// Hash index
+void Dictionary::buildIndex() {
+	std::size_t capacity = 8;
+	while (capacity < 2*size()) capacity *= 2;
+	m_index.assign(capacity, EmptySlot);
+	for (std::size_t i=0; i<size(); i++) indexPlace(i);
+}
+
+void Dictionary::dropIndex() {
+	m_index.clear();
+	m_index.shrink_to_fit();
+}
+
+bool Dictionary::indexed() const {
+	return !m_index.empty();
 }
 
 // TODO: Optional argument for how to handle insertion,
@@ -360,15 +600,20 @@ Dictionary::iterator Dictionary::insert(Brief const& b) {
 	auto position = std::lower_bound(begin(), end(), b, EntryCompare);
 	// Our entry doesn't already exist
 	if (position == end() || position->phrase() != b.phrase()) {
-		// Insert our entry sorted
-		return m_entries.insert(position, b);
+		return insertAt(position, Brief {b});
 	}
-	// Entry already exists
-	else {
-		// Overwrite previous value
-		position->text() = b.text();
-		return position;
+	// Entry already exists, overwrite previous value
+	position->text() = b.text();
+	return position;
+}
+
+Dictionary::iterator Dictionary::insert(Brief&& b) {
+	auto position = std::lower_bound(begin(), end(), b, EntryCompare);
+	if (position == end() || position->phrase() != b.phrase()) {
+		return insertAt(position, std::move(b));
 	}
+	position->text() = std::move(b.text());
+	return position;
 }
 
 void Dictionary::insert(std::initializer_list<Brief> il) {
@@ -377,28 +622,93 @@ void Dictionary::insert(std::initializer_list<Brief> il) {
 
 std::size_t Dictionary::erase(Phrase p) {
 	auto it = find(p);
-	if (it != end()) m_entries.erase(it);
-	return it != end();
+	if (it == end()) return 0;
+	erase(it);
+	return 1;
 }
 
 Dictionary::iterator Dictionary::erase(const_iterator it) {
+	if (indexed()) {
+		std::size_t const i = it - cbegin();
+		indexRemove(i);
+		indexShift(i+1, -1);
+	}
 	return m_entries.erase(it);
 }
 
 Dictionary::iterator Dictionary::erase(const_iterator i, const_iterator j) {
-	return m_entries.erase(i, j);
+	auto result = m_entries.erase(i, j);
+	reindex();
+	return result;
 }
 
-void Dictionary::merge(Dictionary& other) {
-	for (Brief& b : other) insert(b);
+void Dictionary::merge(Dictionary& other, MergePolicy policy) {
+	mergeSorted(other, false, policy, nullptr);
 }
 
-void Dictionary::merge(Dictionary&& other) {
-	for(Brief& b : std::move(other)) insert(b);
+void Dictionary::merge(Dictionary&& other, MergePolicy policy) {
+	mergeSorted(other, true, policy, nullptr);
+}
+
+void Dictionary::merge(Dictionary& other, MergeResolver const& resolve) {
+	mergeSorted(other, false, KeepTheirs, &resolve);
+}
+
+void Dictionary::merge(Dictionary&& other, MergeResolver const& resolve) {
+	mergeSorted(other, true, KeepTheirs, &resolve);
+}
+
+// Shared phrases are settled in place on a first pass forwards, which also
+// counts the new ones. With room to spare, the entries grow by that much
+// and are merged from the back, so nothing before the first new phrase
+// moves. Otherwise they have to move anyway, so go straight to new ones.
+void Dictionary::mergeSorted(Dictionary& other, bool steal, MergePolicy policy, MergeResolver const* resolve) {
+	if (&other == this) return;
+	auto const take = [steal] (auto& x) { return steal? std::move(x): x; };
+
+	std::size_t added = 0;
+	for (auto a=begin(), b=other.begin(); b!=other.end(); /**/) {
+		if (a == end() || EntryCompare(*b, *a)) { ++added; ++b; }
+		else if (EntryCompare(*a, *b)) ++a;
+		else {
+			if (resolve) a->text() = (*resolve)(*a, *b);
+			else if (policy == KeepTheirs) a->text() = take(b->text());
+			++a, ++b;
+		}
+	}
+
+	if (added && m_entries.capacity() < size() + added) {
+		std::vector<Brief> merged {};
+		merged.reserve(size() + added);
+		auto a = begin();
+		for (auto& b : other.m_entries) {
+			while (a != end() && EntryCompare(*a, b)) merged.push_back(std::move(*a++));
+			if (a != end() && !EntryCompare(b, *a)) merged.push_back(std::move(*a++));
+			else merged.push_back(take(b));
+		}
+		std::move(a, end(), std::back_inserter(merged));
+		m_entries = std::move(merged);
+		reindex();
+	}
+	else if (added) {
+		std::ptrdiff_t i = size() - 1, j = other.size() - 1;
+		m_entries.resize(size() + added);
+		for (std::ptrdiff_t out = size() - 1; out > i; out--) {
+			if (i < 0 || EntryCompare(m_entries[i], other.m_entries[j])) {
+				m_entries[out] = take(other.m_entries[j--]);
+				continue;
+			}
+			if (!EntryCompare(other.m_entries[j], m_entries[i])) j--;
+			m_entries[out] = std::move(m_entries[i--]);
+		}
+		reindex();
+	}
+	if (steal) other.clear();
 }
 
 void Dictionary::clear() {
 	m_entries.clear();
+	reindex();
 }
 
 bool Dictionary::contains(Phrase const& p) const {
@@ -406,49 +716,49 @@ bool Dictionary::contains(Phrase const& p) const {
 }
 
 Dictionary::iterator Dictionary::find(Phrase const& p) {
-	auto it = std::lower_bound(begin(), end(), Brief {p, ""}, EntryCompare);
-	if (it == end() || it->phrase() != p) return end();
-	else return it;
+	return find(strokesOf(p));
 }
 
 Dictionary::const_iterator Dictionary::find(Phrase const& p) const {
-	auto it = std::lower_bound(begin(), end(), Brief {p, ""}, EntryCompare);
-	if (it == end() || it->phrase() != p) return end();
-	else return it;
+	return find(strokesOf(p));
+}
+
+bool Dictionary::contains(std::span<Stroke const> s) const {
+	return find(s) != end();
+}
+
+Dictionary::iterator Dictionary::find(std::span<Stroke const> s) {
+	return begin() + search(s);
+}
+
+Dictionary::const_iterator Dictionary::find(std::span<Stroke const> s) const {
+	return begin() + search(s);
 }
 
 Dictionary::iterator Dictionary::lower_bound(Phrase const& p) {
-	return find(p);
+	return std::lower_bound(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 Dictionary::const_iterator Dictionary::lower_bound(Phrase const& p) const {
-	return find(p);
+	return std::lower_bound(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 Dictionary::iterator Dictionary::upper_bound(Phrase const& p) {
-	auto it = find(p);
-	if (it != end()) return it+1;
-	else return end();
+	return std::upper_bound(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 Dictionary::const_iterator Dictionary::upper_bound(Phrase const& p) const {
-	auto it = find(p);
-	if (it != end()) return it+1;
-	else return end();
+	return std::upper_bound(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 std::pair<Dictionary::iterator, Dictionary::iterator>
 Dictionary::equal_range(Phrase const& p) {
-	auto it = find(p);
-	if (it != end()) return {it, it+1};
-	else return {end(), end()};
+	return std::equal_range(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 std::pair<Dictionary::const_iterator, Dictionary::const_iterator>
 Dictionary::equal_range(Phrase const& p) const {
-	auto it = find(p);
-	if (it != end()) return {it, it+1};
-	else return {end(), end()};
+	return std::equal_range(begin(), end(), strokesOf(p), KeyCompare);
 }
 
 // Map methods
@@ -473,8 +783,187 @@ Text const& Dictionary::at(Phrase const& p) const {
 	else throw std::out_of_range {toString(p)};
 }
 
-void Dictionary::sort() {
-	std::sort(begin(), end(), EntryCompare);
+// Position of the entry with phrase 's', or size() if there is none.
+std::size_t Dictionary::search(std::span<Stroke const> s) const {
+	if (indexed()) {
+		auto const hash = indexHash(s);
+		auto const mask = m_index.size() - 1;
+		for (auto i = hash & mask; m_index[i] != EmptySlot; i = (i+1) & mask) {
+			if (slotHash(m_index[i]) != hash) continue;
+			auto const position = slotPosition(m_index[i]);
+			if (samePhrase(m_entries[position].phrase(), s)) return position;
+		}
+		return size();
+	}
+	auto it = std::lower_bound(begin(), end(), s, KeyCompare);
+	if (it == end() || !samePhrase(it->phrase(), s)) return size();
+	else return it - begin();
+}
+
+void Dictionary::findMany(std::span<Phrase const> queries, std::span<const_iterator> out) const {
+	searchMany(queries.size(), [&] (std::size_t i) { return strokesOf(queries[i]); }, out);
+}
+
+void Dictionary::findMany(std::span<Strokes const> queries, std::span<const_iterator> out) const {
+	searchMany(queries.size(), [&] (std::size_t i) { return queries[i]; }, out);
+}
+
+namespace /*detail*/ {
+	void prefetch([[maybe_unused]] void const* p) {
+#	if defined(__GNUC__)
+		__builtin_prefetch(p);
+#	endif
+	}
+}
+
+// Internal
+template <class F>
+void Dictionary::searchMany(std::size_t count, F const& query, std::span<const_iterator> out) const {
+	assert(count <= out.size() && count <= UINT32_MAX);
+	if (indexed()) {
+		// Each group of lookups goes through every step together: first
+		// the slots are fetched, then the entries they point to, then
+		// the phrases are compared. Each step waits on memory just once.
+		constexpr std::size_t Group = 16;
+		auto const mask = m_index.size() - 1;
+		for (std::size_t first=0; first<count; first+=Group) {
+			auto const n = std::min(Group, count - first);
+			uint32_t hash[Group];
+			std::size_t slot[Group], position[Group];
+			for (std::size_t k=0; k<n; k++) {
+				hash[k] = indexHash(query(first + k));
+				slot[k] = hash[k] & mask;
+				prefetch(&m_index[slot[k]]);
+			}
+			for (std::size_t k=0; k<n; k++) {
+				auto i = slot[k];
+				while (m_index[i] != EmptySlot && slotHash(m_index[i]) != hash[k]) i = (i+1) & mask;
+				position[k] = m_index[i] == EmptySlot? size(): slotPosition(m_index[i]);
+				if (position[k] != size()) prefetch(&m_entries[position[k]]);
+			}
+			for (std::size_t k=0; k<n; k++) {
+				auto const s = query(first + k);
+				// Another phrase with the same hash is rare enough to
+				// leave to the usual search.
+				if (position[k] != size() && !samePhrase(m_entries[position[k]].phrase(), s)) {
+					position[k] = search(s);
+				}
+				out[first + k] = begin() + position[k];
+			}
+		}
+		return;
+	}
+
+	// Without an index, the queries are sorted and the entries swept once,
+	// galloping forward from each match to the next. Sorting on the first
+	// stroke's bits (which order the same as strokes do) next to the query
+	// number keeps most comparisons to plain integers.
+	std::vector<uint64_t> order (count);
+	for (std::size_t i=0; i<count; i++) {
+		auto const s = query(i);
+		uint64_t const first = s.empty()? 0: s.front().raw();
+		order[i] = first << 32 | i;
+	}
+	std::sort(order.begin(), order.end());
+	auto const queryLess = [&] (uint64_t a, uint64_t b) {
+		auto const x = query(a & 0xFFFFFFFF), y = query(b & 0xFFFFFFFF);
+		return std::lexicographical_compare(x.begin(), x.end(), y.begin(), y.end());
+	};
+	for (auto run = order.begin(); run != order.end(); /**/) {
+		auto const next = std::find_if(run, order.end(), [&] (uint64_t k) { return k>>32 != *run>>32; });
+		if (next - run > 1) std::sort(run, next, queryLess);
+		run = next;
+	}
+	auto from = begin();
+	for (auto const key : order) {
+		auto const i = key & 0xFFFFFFFF;
+		auto const s = query(i);
+		std::ptrdiff_t step = 1;
+		while (step < end() - from && KeyCompare(from[step], s)) step *= 2;
+		auto const last = end() - from > step? from + step + 1: end();
+		from = std::lower_bound(from + step/2, last, s, KeyCompare);
+		out[i] = (from != end() && samePhrase(from->phrase(), s))? from: end();
+	}
+}
+
+// 'position' must be where the entry sorts, with no entry of that phrase.
+Dictionary::iterator Dictionary::insertAt(const_iterator position, Brief&& b) {
+	auto it = m_entries.insert(position, std::move(b));
+	if (indexed()) {
+		std::size_t const i = it - begin();
+		if (2*size() > m_index.size()) buildIndex();
+		else { indexShift(i, +1); indexPlace(i); }
+	}
+	return it;
+}
+
+void Dictionary::reindex() {
+	if (indexed()) buildIndex();
+}
+
+// Linear probing, the table is never more than half full.
+void Dictionary::indexPlace(std::size_t position) {
+	auto const hash = indexHash(strokesOf(m_entries[position].phrase()));
+	auto const mask = m_index.size() - 1;
+	auto i = hash & mask;
+	while (m_index[i] != EmptySlot) i = (i+1) & mask;
+	m_index[i] = makeSlot(hash, position);
+}
+
+// Backward-shift deletion, so no tombstones are needed.
+void Dictionary::indexRemove(std::size_t position) {
+	auto const hash = indexHash(strokesOf(m_entries[position].phrase()));
+	auto const mask = m_index.size() - 1;
+	auto i = hash & mask;
+	while (m_index[i] != makeSlot(hash, position)) i = (i+1) & mask;
+	for (auto j = (i+1) & mask; m_index[j] != EmptySlot; j = (j+1) & mask) {
+		auto const home = slotHash(m_index[j]) & mask;
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			m_index[i] = m_index[j];
+			i = j;
+		}
+	}
+	m_index[i] = EmptySlot;
+}
+
+// Moves every position at or after 'first' by 'delta'.
+void Dictionary::indexShift(std::size_t first, std::ptrdiff_t delta) {
+	for (uint64_t& slot : m_index) {
+		if (slot != EmptySlot && slotPosition(slot) >= first) slot += delta;
+	}
+}
+
+// Each part between bounds starts with the entries it keeps, which are
+// moved up against those of the parts before.
+std::size_t Dictionary::compact(std::span<std::size_t const> bounds, std::span<std::size_t const> kept) {
+	auto out = m_entries.begin() + bounds[0] + kept[0];
+	for (std::size_t i=1; i<kept.size(); i++) {
+		auto const first = m_entries.begin() + bounds[i];
+		if (out == first) out += kept[i];
+		else out = std::move(first, first + kept[i], out);
+	}
+	std::size_t const removed = m_entries.end() - out;
+	m_entries.erase(out, m_entries.end());
+	if (removed) reindex();
+	return removed;
+}
+
+// Entries before 'sorted' are assumed to be in order already.
+void Dictionary::sort(std::size_t sorted) {
+	auto const middle = begin() + sorted;
+	// Stable, so duplicates keep the order they were inserted in.
+	std::stable_sort(middle, end(), EntryCompare);
+	std::inplace_merge(begin(), middle, end(), EntryCompare);
+	// Of each run of equal phrases, keep only the last.
+	auto out = begin();
+	for (auto it=begin(); it!=end(); ++it) {
+		auto next = it+1;
+		if (next != end() && next->phrase() == it->phrase()) continue;
+		if (out != it) *out = std::move(*it);
+		++out;
+	}
+	m_entries.erase(out, end());
+	reindex();
 }
 
 /* ~~ String Output ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -513,15 +1002,114 @@ namespace /*detail*/ {
 	[[maybe_unused]] bool nohyphen(Format x) { return check<NoHyphen>(x); }
 	[[maybe_unused]] bool numeric (Format x) { return check<Numeric >(x); }
 	[[maybe_unused]] bool alpha   (Format x) { return check<Alpha   >(x); }
+
+	Format streamFormat(std::ios_base& os) {
+		auto format = Format(os.iword(Format_xalloc));
+		return bits(format)? format: StrokeDefault;
+	}
+
+	// Writes a stroke at a time, rather than a character at a time.
+	bool writeText(std::streambuf& buf, Stroke s, Format format) {
+		char buffer[Stroke::KeyCount];
+		auto const size = formatTo(buffer, s, format) - buffer;
+		return buf.sputn(buffer, size) == size;
+	}
+
+	bool writeText(std::streambuf& buf, Phrase const& p, Format format) {
+		char buffer[Stroke::KeyCount + 1];
+		for (int i=0; auto stroke : p) {
+			char* end = buffer;
+			if (i++) *end++ = '/';
+			end = formatTo(end, stroke, format);
+			if (buf.sputn(buffer, end - buffer) != end - buffer) return false;
+		}
+		return true;
+	}
+
+	bool writeText(std::streambuf& buf, Brief const& b, Format format) {
+		std::streamsize const size = b.text().size();
+		return writeText(buf, b.phrase(), format)
+		&&  buf.sputn(", ", 2) == 2
+		&&  buf.sputn(b.text().data(), size) == size;
+	}
+
+	// Streams text straight into the buffer, unless it must be padded to
+	// a width as a whole.
+	template <class T>
+	std::ostream& streamOut(std::ostream& os, T const& x) {
+		if (os.width()) return os << toString(x, streamFormat(os));
+		std::ostream::sentry const ok {os};
+		if (ok && !writeText(*os.rdbuf(), x, streamFormat(os))) os.setstate(std::ios::badbit);
+		return os;
+	}
+
+	constexpr uint32_t keysOf(std::initializer_list<Key> keys) {
+		uint32_t result = 0;
+		for (Key k : keys) result |= uint32_t(k);
+		return result;
+	}
+
+	constexpr uint32_t KeyBits = ~uint32_t{} << Stroke::PadCount;
+	constexpr uint32_t MiddleKeys = keysOf({Key::A, Key::O, Key::x, Key::E, Key::U});
+	// Keys which turn into digits with the number bar.
+	constexpr uint32_t NumberKeys = keysOf({
+		Key::S_, Key::T_, Key::P_, Key::H_, Key::A, Key::O,
+		Key::_F, Key::_P, Key::_L, Key::_T,
+	});
+
+	constexpr char Chars     [] = "#STKPWHRAO*EUFRPBLGTSDZ";
+	constexpr char ShiftChars[] = "#12K3W4R50*EU6R7B8G9SDZ";
+
+	// The text of one group of keys, padded so it can be copied whole.
+	struct Fragment {
+		char text[15] {};
+		uint8_t length = 0;
+	};
+
+	// Every combination of the keys in each group, for one set of
+	// characters and width. The hyphen stands in for an empty middle.
+	struct FragmentTable {
+		std::array<Fragment, 1 << 7> left {};
+		std::array<Fragment, 1 << 5> middle {};
+		std::array<Fragment, 1 << 10> right {};
+		Fragment hyphen {};
+	};
+
+	template <std::size_t N>
+	constexpr void fillFragments(std::array<Fragment, N>& table, char const* chars, bool wide) {
+		unsigned const count = std::countr_zero(N);
+		for (uint32_t keys=0; keys<N; keys++) {
+			auto& f = table[keys];
+			for (unsigned i=0; i<count; i++) {
+				bool const on = keys >> (count-1 - i) & 1;
+				if (on || wide) f.text[f.length++] = on? chars[i]: ' ';
+			}
+		}
+	}
+
+	constexpr FragmentTable makeFragments(char const* chars, bool wide) {
+		FragmentTable result {};
+		fillFragments(result.left,   chars + keyID(Key::S_), wide);
+		fillFragments(result.middle, chars + keyID(Key::A ), wide);
+		fillFragments(result.right,  chars + keyID(Key::_F), wide);
+		result.hyphen = wide? Fragment {"  -  ", 5}: Fragment {"-", 1};
+		return result;
+	}
+
+	// By character set (letters, or digits with the number bar) and width.
+	constexpr FragmentTable Fragments[2][2] = {
+		{makeFragments(Chars, false), makeFragments(Chars, true)},
+		{makeFragments(ShiftChars, false), makeFragments(ShiftChars, true)},
+	};
 }
 
 char toChar(Key k) {
-	return "#STKPWHRAO*EUFRPBLGTSDZ" [keyID(k)];
+	return Chars[keyID(k)];
 }
 
 char toCharShift(Key k) {
 	// The keyboard "shifted" via the number bar.
-	return "#12K3W4R50*EU6R7B8G9SDZ" [keyID(k)];
+	return ShiftChars[keyID(k)];
 }
 
 std::string toString(Key k, Format format) {
@@ -533,56 +1121,65 @@ std::string toString(Key k, Format format) {
 	return result;
 }
 
+char* formatTo(char* out, Stroke s, Format format) {
+	uint32_t const keys = s.raw() & KeyBits;
+	bool const numBar = keys & uint32_t(Key::Num);
+	// Bitwise rather than logical operators, so there are no branches
+	// to mispredict on random strokes.
+	bool const anyNumbers = numBar & bool(keys & NumberKeys);
+	bool const allNumbers = numBar & !(keys & ~(NumberKeys | uint32_t(Key::Num)));
+	bool const showNum = numBar & (alpha(format) | !anyNumbers);
+	bool const showHyphen = !(keys & MiddleKeys) & !(numeric(format) & allNumbers);
+	bool const wide = !packed(format);
+	auto const& table = Fragments[numBar & numeric(format)][wide];
+
+	// Fragments are copied whole into a scratch buffer, each overwriting
+	// the padding of the one before.
+	char buffer[Stroke::KeyCount + sizeof (Fragment)];
+	char* end = buffer;
+	auto const put = [&] (Fragment const& f) {
+		std::memcpy(end, f.text, sizeof f.text);
+		end += f.length;
+	};
+	*end = showNum? '#': ' ';
+	end += showNum | wide;
+	put(table.left[keys >> 24 & 0x7F]);
+	put(showHyphen? table.hyphen: table.middle[keys >> 19 & 0x1F]);
+	put(table.right[keys >> 9 & 0x3FF]);
+
+	std::memcpy(out, buffer, end - buffer);
+	return out + (end - buffer);
+}
+
 std::string toString(Stroke s, Format format) {
-	Stroke const NumBar = s & Stroke {"#         -            "};
-	Stroke const Left   = s & Stroke {" STKPWHR  -            "};
-	Stroke const Middle = s & Stroke {"        AO*EU          "};
-	Stroke const Right  = s & Stroke {"          -  FRPBLGTSDZ"};
-	bool const AnyNumbers = NumBar && (s & steno::Stroke{" STPHAOFPLT"});
-	bool const AllNumbers = NumBar && (s & steno::Stroke{"#STPHAOFPLT"}) == s;
-	auto const toCh = NumBar && numeric(format)? toCharShift: toChar;
-
-	std::string result (Stroke::KeyCount, ' ');
-	auto put = [&] (Key k, char c = '\0') { result[keyID(k)] = c? c: toCh(k); };
-
-	if ( NumBar &&  (alpha  (format) || !AnyNumbers)) put(Key::Num);
-	if (!Middle && !(numeric(format) &&  AllNumbers)) put(Key::x, '-');
-	for (Key key : Left  ) put(key);
-	for (Key key : Middle) put(key);
-	for (Key key : Right ) put(key);
-	if (packed(format)) std::erase(result, ' ');
-	return result;
+	char buffer[Stroke::KeyCount];
+	return {buffer, formatTo(buffer, s, format)};
 }
 
 std::string toString(Phrase const& p, Format format) {
 	std::string result = "";
-	for (int i=0; auto stroke : p) {
-		if (i++) result += '/';
-		result += toString(stroke, format);
-	}
+	result.reserve(p.size() * (Stroke::KeyCount + 1));
+	formatTo(std::back_inserter(result), p, format);
 	return result;
 }
 
 std::string toString(Brief const& b, Format format) {
-	return toString(b.phrase(), format) + ", " + b.text();
+	std::string result = "";
+	result.reserve(b.phrase().size() * (Stroke::KeyCount + 1) + 2 + b.text().size());
+	formatTo(std::back_inserter(result), b, format);
+	return result;
 }
 
 std::ostream& operator<<(std::ostream& os, Stroke s) {
-	auto format = Format(os.iword(Format_xalloc));
-	if (!bits(format)) format = StrokeDefault;
-	return os << toString(s, format);
+	return streamOut(os, s);
 }
 
 std::ostream& operator<<(std::ostream& os, Phrase const& p) {
-	auto format = Format(os.iword(Format_xalloc));
-	if (!bits(format)) format = StrokeDefault;
-	return os << toString(p, format);
+	return streamOut(os, p);
 }
 
 std::ostream& operator<<(std::ostream& os, Brief const& b) {
-	auto format = Format(os.iword(Format_xalloc));
-	if (!bits(format)) format = StrokeDefault;
-	return os << toString(b, format);
+	return streamOut(os, b);
 }
 
 // Format as manipulator
@@ -598,19 +1195,59 @@ std::ostream& operator<<(std::ostream& os, Format f) {
 
 } // namespace steno
 
+namespace /*detail*/ {
+	// Multiply-and-fold mixing, as in wyhash.
+	// https://github.com/wangyi-fudan/wyhash
+	constexpr uint64_t Secret[] = {
+		0xA0761D6478BD642F, 0xE7037ED1A0B428DB, 0x8EBC6AF09C88C6E3,
+	};
+
+	uint64_t mix(uint64_t a, uint64_t b) {
+#	ifdef __SIZEOF_INT128__
+		__uint128_t r = __uint128_t(a) * b;
+		return uint64_t(r) ^ uint64_t(r >> 64);
+#	else
+		uint64_t const ha = a >> 32, la = uint32_t(a);
+		uint64_t const hb = b >> 32, lb = uint32_t(b);
+		uint64_t const ll = la*lb, hl = ha*lb, lh = la*hb, hh = ha*hb;
+		uint64_t const cross = (ll >> 32) + uint32_t(hl) + lh;
+		uint64_t const upper = (hl >> 32) + (cross >> 32) + hh;
+		uint64_t const lower = (cross << 32) | uint32_t(ll);
+		return lower ^ upper;
+#	endif
+	}
+
+	// Two adjacent strokes as one word.
+	uint64_t load2(uint32_t const* p) {
+		uint64_t word;
+		std::memcpy(&word, p, sizeof word);
+		return word;
+	}
+}
+
 std::size_t std::hash<steno::Stroke>::operator()(steno::Stroke const& x) const {
-	return std::hash<uint32_t> {} (x.m_bits);
+	return mix(x.m_bits ^ Secret[0], Secret[1]);
 }
 
-// https://stackoverflow.com/a/72073933
 std::size_t std::hash<steno::Phrase>::operator()(steno::Phrase const& x) const {
-	std::size_t seed = x.size();
-	for (auto stroke : x) {
-		uint32_t n = stroke.m_bits;
-		n = ((n >> 16) ^ n) & 0x45D9F3B;
-		n = ((n >> 16) ^ n) & 0x45D9F3B;
-		n = (n >> 16) ^ n;
-		seed ^= x + 0x9E3779B9 + (seed << 6) + (seed >> 2);
-	}
-	return seed;
+	return (*this)(std::span<steno::Stroke const> {x.begin(), x.end()});
+}
+
+std::size_t std::hash<steno::Phrase>::operator()(
+	std::span<steno::Stroke const> x
+) const {
+	static_assert(sizeof (steno::Stroke) == sizeof (uint32_t));
+	static_assert(std::is_trivially_copyable_v<steno::Stroke>);
+	// Strokes are read straight out of the span, four at a time.
+	auto const* data = reinterpret_cast<uint32_t const*>(x.data());
+	std::size_t const n = x.size();
+	uint64_t seed = mix(Secret[0] ^ n, Secret[1]);
+	std::size_t i = 0;
+	for (; i+4 <= n; i += 4) {
+		seed = mix(load2(data+i) ^ Secret[1], load2(data+i+2) ^ seed);
+	}
+	uint64_t a = 0, b = 0;
+	if (n-i >= 2) { a = load2(data+i); i += 2; }
+	if (n-i == 1) { b = data[i]; }
+	return mix(Secret[1] ^ n, mix(a ^ Secret[1], b ^ seed ^ Secret[2]));
 }
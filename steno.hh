@@ -5,7 +5,9 @@
 #include <bit>
 #include <bitset>
 #include <vector>
-#include <deque>
+#include <memory>
+#include <compare>
+#include <concepts>
 #include <list>
 #include <span>
 #include <initializer_list>
@@ -14,8 +16,13 @@
 #include <type_traits>
 #include <algorithm>
 #include <functional>
+#include <thread>
 #include <cstdint>
 #include <cassert>
+#include <version>
+#if __has_include(<format>)
+#	include <format>
+#endif
 
 namespace steno {
 
@@ -109,6 +116,10 @@ public:
 	friend Stroke operator&(Stroke, Stroke const&);
 	friend Stroke operator^(Stroke, Stroke const&);
 
+	// Bulk parsing
+	friend void parseStrokes(std::span<std::string_view const>, std::span<Stroke>);
+	friend std::size_t parseStrokes(std::string_view, std::span<Stroke>, char);
+
 public:
 	// Key proxy class
 	class Reference {
@@ -148,6 +159,14 @@ private:
 	void failConstruction(std::string_view = "");
 };
 
+// Bulk parsing
+// The same as Stroke(std::string_view) to the bit, failures included, but
+// table driven for speed at runtime.
+void parseStrokes(std::span<std::string_view const>, std::span<Stroke>);
+// Splits the text at every delimiter, and returns how many strokes there
+// were. Only as many as fit are written.
+std::size_t parseStrokes(std::string_view, std::span<Stroke>, char delimiter = '/');
+
 // Key promotion
 Stroke operator~(Key);
 Stroke operator+(Key, Key);
@@ -157,14 +176,33 @@ Stroke operator^(Key, Key);
 
 /* ~~ Phrase Class ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+// Phrases of up to this many strokes are stored without heap allocation.
+#ifndef STENO_PHRASE_INLINE
+#	define STENO_PHRASE_INLINE 4
+#endif
+
 class Phrase {
-	std::vector<Stroke> m_strokes {};
+public:
+	static constexpr std::size_t InlineCount = STENO_PHRASE_INLINE;
+	static_assert(InlineCount >= 2, "Room for at least one pointer");
+
+private:
+	union Storage {
+		Stroke local[InlineCount];
+		Stroke* heap;
+		Storage() {}
+	} m_storage;
+	uint32_t m_size = 0;
+	uint32_t m_capacity = InlineCount;
 
 public:
 	// Default construction/assignment
 	Phrase() = default;
-	Phrase(Phrase const&) = default;
-	Phrase& operator=(Phrase const&) = default;
+	Phrase(Phrase const&);
+	Phrase(Phrase&&) noexcept;
+	Phrase& operator=(Phrase const&);
+	Phrase& operator=(Phrase&&) noexcept;
+	~Phrase();
 
 	// Class constructors
 	Phrase(std::string_view);
@@ -176,12 +214,13 @@ public:
 	operator bool() const;
 
 	// Comparison
-	bool operator== (Phrase const&) const = default;
-	auto operator<=>(Phrase const&) const = default;
+	bool operator== (Phrase const&) const;
+	std::strong_ordering operator<=>(Phrase const&) const;
 	template <class T> friend struct std::hash;
 
 	// Concatenation
-	Phrase& operator|=(Phrase);
+	Phrase& operator|=(Phrase const&);
+	Phrase& operator|=(Phrase&&);
 	friend Phrase operator|(Phrase, Phrase const&);
 
 public:
@@ -189,59 +228,110 @@ public:
 	using value_type = Stroke;
 	using reference = Stroke&;
 	using const_reference = Stroke const&;
-	using iterator = decltype(m_strokes)::iterator;
-	using const_iterator = decltype(m_strokes)::const_iterator;
+	using iterator = Stroke*;
+	using const_iterator = Stroke const*;
 	using reverse_iterator = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 	using difference_type = std::ptrdiff_t;
 	using size_type = std::size_t;
 
 	// Container methods
-#	define USE(Name) \
-	auto    Name()       { return m_strokes.   Name(); } \
-	auto    Name() const { return m_strokes.   Name(); } \
-	auto c##Name() const { return m_strokes.c##Name(); }
-	USE(begin) USE(end) USE(rbegin) USE(rend)
-#	undef USE
+	Stroke      * data()       { return local()? m_storage.local: m_storage.heap; }
+	Stroke const* data() const { return local()? m_storage.local: m_storage.heap; }
+	iterator       begin()       { return data(); }
+	const_iterator begin() const { return data(); }
+	iterator       end  ()       { return data() + m_size; }
+	const_iterator end  () const { return data() + m_size; }
+	reverse_iterator       rbegin()       { return reverse_iterator {end()}; }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator {end()}; }
+	reverse_iterator       rend  ()       { return reverse_iterator {begin()}; }
+	const_reverse_iterator rend  () const { return const_reverse_iterator {begin()}; }
+	const_iterator         cbegin () const { return begin (); }
+	const_iterator         cend   () const { return end   (); }
+	const_reverse_iterator crbegin() const { return rbegin(); }
+	const_reverse_iterator crend  () const { return rend  (); }
 	void swap(Phrase& other) { std::swap(*this, other); };
-	std::size_t size    () const { return m_strokes.size    (); }
-	std::size_t max_size() const { return m_strokes.max_size(); }
-	bool        empty   () const { return m_strokes.empty   (); }
+	std::size_t size    () const { return m_size; }
+	std::size_t max_size() const { return UINT32_MAX; }
+	std::size_t capacity() const { return m_capacity; }
+	bool        empty   () const { return m_size == 0; }
+	void        reserve (std::size_t n) { if (n > m_capacity) grow(n); }
 
 public:
 	// Sequence methods
 	template <std::input_iterator I>
-	Phrase(I first, I last): m_strokes(first, last) {}
-	Phrase(std::initializer_list<Stroke> il): m_strokes(il) {};
-	Phrase(std::size_t n, Stroke t): m_strokes(n, t) {}
-	auto emplace(auto&& ... args) { return m_strokes.emplace(args ... ); }
-	auto insert (auto&& ... args) { return m_strokes.insert (args ... ); }
-	auto erase  (auto&& ... args) { return m_strokes.erase  (args ... ); }
-	auto clear  (auto&& ... args) { return m_strokes.clear  (args ... ); }
-	auto assign (auto&& ... args) { return m_strokes.assign (args ... ); }
+	Phrase(I first, I last) { insert(end(), first, last); }
+	Phrase(std::initializer_list<Stroke> il) { insert(end(), il); };
+	Phrase(std::size_t n, Stroke t) { insert(end(), n, t); }
+	iterator emplace(const_iterator p, auto&& ... args)
+	{ return insert(p, Stroke (std::forward<decltype(args)>(args) ... )); }
+	iterator insert(const_iterator p, Stroke t)
+	{ auto gap = makeRoom(p, 1); *gap = t; return gap; }
+	iterator insert(const_iterator p, std::size_t n, Stroke t)
+	{ auto gap = makeRoom(p, n); std::fill_n(gap, n, t); return gap; }
+	template <std::input_iterator I>
+	iterator insert(const_iterator p, I first, I last);
+	iterator insert(const_iterator p, std::initializer_list<Stroke> il)
+	{ return insert(p, il.begin(), il.end()); }
+	iterator erase(const_iterator);
+	iterator erase(const_iterator, const_iterator);
+	void clear() { m_size = 0; }
+	template <std::input_iterator I>
+	void assign(I first, I last) { clear(); insert(end(), first, last); }
+	void assign(std::initializer_list<Stroke> il) { assign(il.begin(), il.end()); }
+	void assign(std::size_t n, Stroke t) { clear(); insert(end(), n, t); }
 
 	// Vector methods
-	auto& front  ()       { return m_strokes.front(); }
-	auto& front  () const { return m_strokes.front(); }
-	auto& back   ()       { return m_strokes.back (); }
-	auto& back   () const { return m_strokes.back (); }
-	auto  emplace_back(auto&& ... args)   { m_strokes.emplace_back(args ... ); }
-	auto  push_back   (auto&& ... args)   { m_strokes.push_back   (args ... ); }
-	auto  pop_back  ()                    { m_strokes.pop_back    ();          }
-	[[nodiscard]] auto& operator[](auto n)       { return m_strokes[n];    }
-	[[nodiscard]] auto& operator[](auto n) const { return m_strokes[n];    }
-	[[nodiscard]] auto& at        (auto n)       { return m_strokes.at(n); }
-	[[nodiscard]] auto& at        (auto n) const { return m_strokes.at(n); }
+	Stroke      & front()       { return data()[0]; }
+	Stroke const& front() const { return data()[0]; }
+	Stroke      & back ()       { return data()[m_size-1]; }
+	Stroke const& back () const { return data()[m_size-1]; }
+	void emplace_back(auto&& ... args)
+	{ push_back(Stroke (std::forward<decltype(args)>(args) ... )); }
+	void push_back(Stroke t)
+	{ if (m_size == m_capacity) grow(2*m_capacity); data()[m_size++] = t; }
+	void pop_back() { m_size--; }
+	[[nodiscard]] Stroke      & operator[](std::size_t n)       { return data()[n]; }
+	[[nodiscard]] Stroke const& operator[](std::size_t n) const { return data()[n]; }
+	[[nodiscard]] Stroke      & at(std::size_t);
+	[[nodiscard]] Stroke const& at(std::size_t) const;
 	friend void erase   (Phrase& p, auto&& value);
 	friend void erase_if(Phrase& p, auto&& pred);
 
 private:
+	bool local() const { return m_capacity == InlineCount; }
+	void grow(std::size_t);
+	iterator makeRoom(const_iterator, std::size_t);
 	void erase_impl(auto&& value)
 	{ erase(std::remove(begin(), end(), value), end()); }
 	void erase_if_impl(auto&& pred)
 	{ erase(std::remove_if(begin(), end(), pred), end()); }
 };
 
+template <std::input_iterator I>
+Phrase::iterator Phrase::insert(const_iterator p, I first, I last) {
+	if constexpr (std::contiguous_iterator<I>) {
+		// The source may be part of this phrase, and move if we grow.
+		auto const* source = std::to_address(first);
+		if (source >= cbegin() && source <= cend()) {
+			Phrase const copy (first, last);
+			return insert(p, copy.begin(), copy.end());
+		}
+	}
+	if constexpr (std::forward_iterator<I>) {
+		auto gap = makeRoom(p, std::distance(first, last));
+		std::copy(first, last, gap);
+		return gap;
+	}
+	else {
+		auto const offset = p - cbegin();
+		for (auto it = begin() + offset; first != last; ++first) {
+			it = insert(it, *first) + 1;
+		}
+		return begin() + offset;
+	}
+}
+
 // Stroke promotion
 Phrase operator|(Stroke, Stroke const&);
 
@@ -255,10 +345,15 @@ public:
 	// Default construction/assignment
 	Brief() = default;
 	Brief(Brief const&) = default;
+	Brief(Brief&&     ) = default;
 	Brief& operator=(Brief const&) = default;
+	Brief& operator=(Brief&&     ) = default;
 
 	// Class constructors
-	Brief(Phrase const&, std::string_view);
+	// Rvalue phrases and strings are moved in rather than copied.
+	Brief(Phrase, std::string_view);
+	Brief(Phrase p, std::same_as<std::string> auto&& text)
+	:	m_phrase{std::move(p)}, m_text{std::move(text)} { normalize(); }
 	Brief(Brief const&, std::string_view);
 
 	// Fail-state query
@@ -304,8 +399,16 @@ Brief operator+(std::string_view, Phrase);
 
 using Text = std::string;
 
+// Which text to keep when merging dictionaries that share a phrase.
+enum MergePolicy { KeepOurs, KeepTheirs };
+using MergeResolver = std::function<Text (Brief const& ours, Brief const& theirs)>;
+
 class Dictionary {
-	std::deque<Brief> m_entries {};
+	// Kept sorted by phrase, in one contiguous block.
+	std::vector<Brief> m_entries {};
+	// Optional open-addressing table of positions into m_entries.
+	// Each slot holds (hash << 32 | position + 1), or 0 when empty.
+	std::vector<uint64_t> m_index {};
 
 public:
 	// Default construction/assignment/movement
@@ -325,8 +428,21 @@ public:
 	void clean();
 
 	// Comparison
-	bool operator== (Dictionary const&) const = default;
-	auto operator<=>(Dictionary const&) const = default;
+	bool operator== (Dictionary const& other) const
+	{ return m_entries ==  other.m_entries; }
+	auto operator<=>(Dictionary const& other) const
+	{ return m_entries <=> other.m_entries; }
+
+	// Hash index
+	// Once built, the index is kept up to date by every modifier, and
+	// find() becomes a single probe instead of a binary search. It is meant
+	// for dictionaries built in bulk and then mostly read: each insert or
+	// erase of a single entry rescans the whole index, on top of moving the
+	// entries after it. For a batch of such edits, drop the index first and
+	// build it again after.
+	void buildIndex();
+	void dropIndex();
+	bool indexed() const;
 
 public:
 	// Container types
@@ -353,6 +469,7 @@ public:
 	std::size_t size    () const { return m_entries.size    (); }
 	std::size_t max_size() const { return m_entries.max_size(); }
 	bool        empty   () const { return m_entries.empty   (); }
+	void        reserve (std::size_t n) { m_entries.reserve(n); }
 
 public:
 	// Associative types
@@ -361,22 +478,46 @@ public:
 
 	// Associative methods
 	iterator insert(Brief const&);
+	iterator insert(Brief&&);
 	template <std::input_iterator I>
-	Dictionary(I first, I last): m_entries(first, last) { sort(); }
-	Dictionary(std::initializer_list<Brief> il): m_entries(il) { sort(); };
+	Dictionary(I first, I last) { insert(first, last); }
+	Dictionary(std::initializer_list<Brief> il) { insert(il); };
+	// Bulk insertion appends everything, then sorts once. When a phrase
+	// appears more than once the last entry wins, same as repeated insert().
 	template <std::input_iterator I>
-	void insert(I i, I j) { for (I it=i; it!=j; ++it) insert(*it); }
+	void insert(I i, I j) {
+		auto const sorted = size();
+		m_entries.insert(end(), i, j);
+		sort(sorted);
+	}
 	void insert(std::initializer_list<Brief>);
-	iterator emplace(auto&& ... args) { return insert(Brief {args ... }); }
+	iterator emplace(auto&& ... args)
+	{ return insert(Brief {std::forward<decltype(args)>(args) ... }); }
+	// Only builds the text, from 'args', if the phrase isn't there already.
+	std::pair<iterator, bool> try_emplace(Phrase, auto&& ... args);
 	std::size_t erase(Phrase);
 	iterator erase(const_iterator);
 	iterator erase(const_iterator, const_iterator);
-	void merge(Dictionary&);
-	void merge(Dictionary&&);
+	// A single pass over both, as each is sorted already. By default the
+	// other's text wins, the same as inserting its entries one by one, and
+	// an rvalue dictionary has its entries moved out and is left empty.
+	void merge(Dictionary& , MergePolicy = KeepTheirs);
+	void merge(Dictionary&&, MergePolicy = KeepTheirs);
+	// Or each phrase in both gets whatever text 'resolve' returns.
+	void merge(Dictionary& , MergeResolver const& resolve);
+	void merge(Dictionary&&, MergeResolver const& resolve);
 	void clear();
 	bool contains(Phrase const&) const;
 	/*  */iterator find(Phrase const&);
 	const_iterator find(Phrase const&) const;
+	// Lookup by strokes directly, no Phrase needs to be allocated.
+	bool contains(std::span<Stroke const>) const;
+	/*  */iterator find(std::span<Stroke const>);
+	const_iterator find(std::span<Stroke const>) const;
+	// The same as out[i] = find(queries[i]) for every query, but with many
+	// lookups in flight at once. Worth it from a few dozen queries up.
+	void findMany(std::span<Phrase const>, std::span<const_iterator>) const;
+	void findMany(std::span<std::span<Stroke const> const>, std::span<const_iterator>) const;
 	/*  */iterator lower_bound(Phrase const&);
 	const_iterator lower_bound(Phrase const&) const;
 	/*  */iterator upper_bound(Phrase const&);
@@ -389,15 +530,33 @@ public:
 	Text const& operator[](Phrase const&) const;
 	Text& at(Phrase const&);
 	Text const& at(Phrase const&) const;
-	friend void erase   (Dictionary& p, auto&& value);
-	friend void erase_if(Dictionary& p, auto&& pred);
+	// Both remove every match in a single pass, keeping the rest in order,
+	// and return how many went.
+	friend std::size_t erase   (Dictionary& p, auto&& value);
+	friend std::size_t erase_if(Dictionary& p, auto&& pred);
+	// The same as erase_if(), with the predicate run over parts of the
+	// dictionary on separate threads, all of the machine's by default. The
+	// predicate has to be safe to call from several threads at once.
+	std::size_t eraseIfParallel(auto&& pred, unsigned threads = 0);
 
 private:
-	void sort();
-	void erase_if_impl(auto&& pred)
-	{ for (auto it=begin(); it!=end(); ++it) if (pred(*it)) erase(it); }
-	void erase_impl(auto&& value)
-	{ erase_if_impl([&] (auto y) { return value == y; }); }
+	void sort(std::size_t sorted = 0);
+	void mergeSorted(Dictionary&, bool steal, MergePolicy, MergeResolver const*);
+	iterator insertAt(const_iterator, Brief&&);
+	std::size_t search(std::span<Stroke const>) const;
+	template <class F> void searchMany(std::size_t, F const&, std::span<const_iterator>) const;
+	void reindex();
+	void indexPlace(std::size_t);
+	void indexRemove(std::size_t);
+	void indexShift(std::size_t, std::ptrdiff_t);
+	std::size_t erase_if_impl(auto&& pred) {
+		auto const removed = std::erase_if(m_entries, [&] (Brief const& b) { return bool (pred(b)); });
+		if (removed) reindex();
+		return removed;
+	}
+	std::size_t erase_impl(auto&& value)
+	{ return erase_if_impl([&] (Brief const& y) { return value == y; }); }
+	std::size_t compact(std::span<std::size_t const> bounds, std::span<std::size_t const> kept);
 };
 
 /* ~~ String Output ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -433,6 +592,12 @@ std::ostream& operator<<(std::ostream&, Stroke       );
 std::ostream& operator<<(std::ostream&, Phrase const&);
 std::ostream& operator<<(std::ostream&, Brief  const&);
 
+// Allocation-free output into the caller's buffer, returning the end of
+// what was written. A stroke takes at most Stroke::KeyCount characters.
+char* formatTo(char*, Stroke, Format = StrokeDefault);
+template <std::output_iterator<char> O> O formatTo(O, Phrase const&, Format = StrokeDefault);
+template <std::output_iterator<char> O> O formatTo(O, Brief  const&, Format = StrokeDefault);
+
 // Format as manipulator
 std::ostream& operator<<(std::ostream&, Format);
 
@@ -557,6 +722,24 @@ constexpr Stroke::Stroke(I first, I last) {
 	}
 }
 
+template <std::output_iterator<char> O>
+O formatTo(O out, Phrase const& p, Format format) {
+	char buffer[Stroke::KeyCount];
+	for (int i=0; auto stroke : p) {
+		if (i++) *out++ = '/';
+		out = std::copy(buffer, formatTo(buffer, stroke, format), out);
+	}
+	return out;
+}
+
+template <std::output_iterator<char> O>
+O formatTo(O out, Brief const& b, Format format) {
+	out = formatTo(out, b.phrase(), format);
+	*out++ = ',';
+	*out++ = ' ';
+	return std::copy(b.text().begin(), b.text().end(), out);
+}
+
 static constexpr auto NoStroke = Stroke {};
 static const/**/ auto NoPhrase = Phrase {};
 static const/**/ auto NoBrief  = Brief  {};
@@ -569,8 +752,11 @@ static const/**/ auto NoText   = Text   {};
 template <> struct std::hash<steno::Stroke>
 { std::size_t operator()(steno::Stroke const&) const; };
 
-template <> struct std::hash<steno::Phrase>
-{ std::size_t operator()(steno::Phrase const&) const; };
+template <> struct std::hash<steno::Phrase> {
+	using is_transparent = void;
+	std::size_t operator()(steno::Phrase const&) const;
+	std::size_t operator()(std::span<steno::Stroke const>) const;
+};
 
 template <> struct std::tuple_size<steno::Brief>
 : std::integral_constant<size_t, 2> {};
@@ -579,14 +765,98 @@ template <std::size_t I> struct std::tuple_element<I, steno::Brief>
 : std::conditional<I == 0, steno::Phrase, std::string>
 { static_assert(I < 2); };
 
+#ifdef __cpp_lib_format
+// The format spec picks out a Format by letter: 'p'acked or 'w'ide, and
+// 'n'umeric or 'a'lpha. So "{:wa}" matches toString(x, Wide | Alpha).
+template <> struct std::formatter<steno::Stroke> {
+	steno::Format style = steno::StrokeDefault;
+
+	constexpr auto parse(std::format_parse_context& ctx) {
+		long bits = long(style);
+		auto set = [&] (long mask, steno::Format f) { bits = (bits & ~mask) | long(f); };
+		auto it = ctx.begin();
+		for (; it != ctx.end() && *it != '}'; ++it) switch (*it) {
+			case 'p': set(0b00'00'11, steno::Packed ); break;
+			case 'w': set(0b00'00'11, steno::Wide   ); break;
+			case 'n': set(0b11'00'00, steno::Numeric); break;
+			case 'a': set(0b11'00'00, steno::Alpha  ); break;
+			default: throw std::format_error {"Invalid format spec for steno"};
+		}
+		style = steno::Format(bits);
+		return it;
+	}
+
+	auto format(steno::Stroke s, std::format_context& ctx) const {
+		char buffer[steno::Stroke::KeyCount];
+		return std::copy(buffer, steno::formatTo(buffer, s, style), ctx.out());
+	}
+};
+
+template <> struct std::formatter<steno::Phrase> : std::formatter<steno::Stroke> {
+	auto format(steno::Phrase const& p, std::format_context& ctx) const
+	{ return steno::formatTo(ctx.out(), p, style); }
+};
+
+template <> struct std::formatter<steno::Brief> : std::formatter<steno::Stroke> {
+	auto format(steno::Brief const& b, std::format_context& ctx) const
+	{ return steno::formatTo(ctx.out(), b, style); }
+};
+#endif
+
 namespace steno {
 void erase   (Phrase&     t, auto&& x) { t.erase_impl(x);    }
 void erase_if(Phrase&     t, auto&& f) { t.erase_if_impl(f); }
-void erase   (Dictionary& t, auto&& x) { t.erase_impl(x);    }
-void erase_if(Dictionary& t, auto&& f) { t.erase_if_impl(f); }
+std::size_t erase   (Dictionary& t, auto&& x) { return t.erase_impl(x);    }
+std::size_t erase_if(Dictionary& t, auto&& f) { return t.erase_if_impl(f); }
 template <std::size_t I> auto&& get(Brief&       b) { return b.get_impl<I>(); }
 template <std::size_t I> auto&& get(Brief const& b) { return b.get_impl<I>(); }
 template <std::size_t I> auto&& get(Brief&&      b) { return b.get_impl<I>(); }
+
+// The layout of Dictionary's hash index, which binary dictionaries store as
+// it is. Slots pack the low half of the phrase's hash next to one more than
+// its position, so most mismatches are rejected without touching entries.
+namespace hashIndex {
+	constexpr uint64_t EmptySlot = 0;
+	constexpr uint32_t slotHash(uint64_t slot) { return slot >> 32; }
+	constexpr std::size_t slotPosition(uint64_t slot) { return (slot & 0xFFFFFFFF) - 1; }
+	constexpr uint64_t makeSlot(uint32_t hash, std::size_t position) {
+		return uint64_t(hash) << 32 | uint64_t(position + 1);
+	}
+	inline uint32_t indexHash(std::span<Stroke const> s) {
+		return std::hash<Phrase> {} (s);
+	}
+}
+
+std::pair<Dictionary::iterator, bool> Dictionary::try_emplace(Phrase p, auto&& ... args) {
+	steno::erase(p, NoStroke); // As Brief would
+	auto const position = lower_bound(p);
+	if (position != end() && position->phrase() == p) return {position, false};
+	Text text (std::forward<decltype(args)>(args) ...);
+	return {insertAt(position, Brief {std::move(p), std::move(text)}), true};
+}
+
+// Each thread packs the entries it keeps to the front of its own part,
+// then compact() closes the gaps between parts.
+std::size_t Dictionary::eraseIfParallel(auto&& pred, unsigned threads) {
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	// Below this, a thread isn't worth starting.
+	constexpr std::size_t MinimumChunk = 1 << 14;
+	std::size_t const count = std::clamp<std::size_t>(size() / MinimumChunk, 1, threads);
+
+	std::vector<std::size_t> bounds (count + 1), kept (count);
+	for (std::size_t i=0; i<=count; i++) bounds[i] = i * size() / count;
+	auto const compactChunk = [&] (std::size_t i) {
+		auto const first = m_entries.begin() + bounds[i];
+		auto const last  = m_entries.begin() + bounds[i+1];
+		kept[i] = std::remove_if(first, last, [&] (Brief const& b) { return bool (pred(b)); }) - first;
+	};
+	{
+		std::vector<std::jthread> workers {};
+		for (std::size_t i=1; i<count; i++) workers.emplace_back(compactChunk, i);
+		compactChunk(0);
+	}
+	return compact(bounds, kept);
+}
 }
 
 using steno::erase;
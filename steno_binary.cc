@@ -0,0 +1,227 @@
+#include "steno_binary.hh"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace steno {
+
+// Strokes are read straight out of the file as their raw bits.
+static_assert(sizeof (Stroke) == sizeof (uint32_t));
+static_assert(std::is_trivially_copyable_v<Stroke>);
+static_assert(std::is_standard_layout_v<BinaryHeader>);
+
+namespace /*detail*/ {
+	constexpr uint64_t Alignment = 8;
+	uint64_t aligned(uint64_t n) { return (n + Alignment-1) & ~(Alignment-1); }
+
+	// The index is Dictionary's own, so changing its layout or
+	// std::hash<Phrase> means bumping BinaryHeader::CurrentVersion.
+	using namespace hashIndex;
+
+	template <class T>
+	void writeSection(std::ostream& os, std::vector<T> const& data) {
+		os.write(reinterpret_cast<char const*>(data.data()), data.size() * sizeof (T));
+		static constexpr char padding[Alignment] {};
+		os.write(padding, aligned(data.size() * sizeof (T)) - data.size() * sizeof (T));
+	}
+
+	// Offsets must start at zero and never decrease, ending at 'total'.
+	bool validOffsets(uint32_t const* offsets, uint32_t count, uint32_t total) {
+		if (offsets[0] != 0 || offsets[count] != total) return false;
+		for (uint32_t i=0; i<count; i++) {
+			if (offsets[i] > offsets[i+1]) return false;
+		}
+		return true;
+	}
+}
+
+/* ~~ Writing ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+bool writeBinary(std::ostream& os, Dictionary const& dict, bool index) {
+	std::vector<uint32_t> keyOffsets {0}, strokes {}, textOffsets {0};
+	std::vector<char> text {};
+	keyOffsets.reserve(dict.size() + 1);
+	textOffsets.reserve(dict.size() + 1);
+	for (auto const& entry : dict) {
+		for (auto stroke : entry.phrase()) strokes.push_back(stroke.raw());
+		text.insert(text.end(), entry.text().begin(), entry.text().end());
+		if (text.size() > UINT32_MAX || strokes.size() > UINT32_MAX) return false;
+		keyOffsets.push_back(strokes.size());
+		textOffsets.push_back(text.size());
+	}
+	if (dict.size() >= UINT32_MAX) return false;
+
+	std::vector<uint64_t> slots {};
+	if (index) {
+		std::size_t capacity = 8;
+		while (capacity < 2*dict.size()) capacity *= 2;
+		slots.assign(capacity, EmptySlot);
+		auto const mask = capacity - 1;
+		for (std::size_t position=0; position<dict.size(); position++) {
+			auto const hash = indexHash(dict.begin()[position].phrase());
+			auto i = hash & mask;
+			while (slots[i] != EmptySlot) i = (i+1) & mask;
+			slots[i] = makeSlot(hash, position);
+		}
+	}
+
+	BinaryHeader header {};
+	std::memcpy(header.magic, BinaryHeader::Magic, sizeof header.magic);
+	header.version = BinaryHeader::CurrentVersion;
+	header.byteOrder = BinaryHeader::ByteOrderMark;
+	header.entries = dict.size();
+	header.strokes = strokes.size();
+	header.textBytes = text.size();
+	header.indexSize = slots.size();
+	header.keyOffsets = aligned(sizeof header);
+	header.strokeData = header.keyOffsets + aligned(keyOffsets.size() * 4);
+	header.textOffsets = header.strokeData + aligned(strokes.size() * 4);
+	header.textData = header.textOffsets + aligned(textOffsets.size() * 4);
+	header.index = header.textData + aligned(text.size());
+
+	os.write(reinterpret_cast<char const*>(&header), sizeof header);
+	os.write("\0\0\0\0\0\0\0", aligned(sizeof header) - sizeof header);
+	writeSection(os, keyOffsets);
+	writeSection(os, strokes);
+	writeSection(os, textOffsets);
+	writeSection(os, text);
+	writeSection(os, slots);
+	return bool(os);
+}
+
+/* ~~ Mapped Dictionary ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+std::optional<MappedDictionary> MappedDictionary::open(char const* path) {
+	int const fd = ::open(path, O_RDONLY);
+	if (fd < 0) return {};
+	struct stat info {};
+	void* data = MAP_FAILED;
+	if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof (BinaryHeader)) {
+		data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	// The mapping holds its own reference to the file.
+	::close(fd);
+	if (data == MAP_FAILED) return {};
+
+	MappedDictionary result {data, std::size_t(info.st_size)};
+	if (!result.valid()) return {};
+	return result;
+}
+
+MappedDictionary::MappedDictionary(void const* data, std::size_t length)
+:	m_data{data}, m_length{length} {
+	auto const* base = static_cast<char const*>(data);
+	m_header = reinterpret_cast<BinaryHeader const*>(base);
+	m_keyOffsets  = reinterpret_cast<uint32_t const*>(base + m_header->keyOffsets);
+	m_strokes     = reinterpret_cast<Stroke   const*>(base + m_header->strokeData);
+	m_textOffsets = reinterpret_cast<uint32_t const*>(base + m_header->textOffsets);
+	m_text        = base + m_header->textData;
+	m_index       = reinterpret_cast<uint64_t const*>(base + m_header->index);
+}
+
+MappedDictionary::MappedDictionary(MappedDictionary&& other) {
+	*this = std::move(other);
+}
+
+MappedDictionary& MappedDictionary::operator=(MappedDictionary&& other) {
+	std::swap(m_data, other.m_data);
+	std::swap(m_length, other.m_length);
+	std::swap(m_header, other.m_header);
+	std::swap(m_keyOffsets, other.m_keyOffsets);
+	std::swap(m_strokes, other.m_strokes);
+	std::swap(m_textOffsets, other.m_textOffsets);
+	std::swap(m_text, other.m_text);
+	std::swap(m_index, other.m_index);
+	return *this;
+}
+
+MappedDictionary::~MappedDictionary() {
+	if (m_data) munmap(const_cast<void*>(m_data), m_length);
+}
+
+MappedDictionary::Iterator MappedDictionary::find(std::span<Stroke const> s) const {
+	if (indexed()) {
+		auto const hash = indexHash(s);
+		auto const mask = m_header->indexSize - 1;
+		for (auto i = hash & mask; m_index[i] != EmptySlot; i = (i+1) & mask) {
+			if (slotHash(m_index[i]) != hash) continue;
+			auto const position = slotPosition(m_index[i]);
+			if (std::ranges::equal(entry(position).phrase, s)) return {this, uint32_t(position)};
+		}
+		return end();
+	}
+
+	// Binary search over positions, as the entries aren't an array.
+	uint32_t first = 0, count = size();
+	while (count > 0) {
+		auto const half = count / 2;
+		auto const phrase = entry(first + half).phrase;
+		if (std::lexicographical_compare(phrase.begin(), phrase.end(), s.begin(), s.end())) {
+			first += half + 1;
+			count -= half + 1;
+		}
+		else count = half;
+	}
+	if (first < size() && std::ranges::equal(entry(first).phrase, s)) return {this, first};
+	return end();
+}
+
+bool MappedDictionary::contains(std::span<Stroke const> s) const {
+	return find(s) != end();
+}
+
+std::string_view MappedDictionary::at(std::span<Stroke const> s) const {
+	auto const it = find(s);
+	if (it == end()) throw std::out_of_range {"MappedDictionary::at"};
+	return (*it).text;
+}
+
+Dictionary MappedDictionary::toDictionary() const {
+	// Entries are already sorted, so the bulk insert has nothing to merge.
+	return Dictionary {begin(), end()};
+}
+
+// Internal
+BriefView MappedDictionary::entry(uint32_t i) const {
+	return {
+		{m_strokes + m_keyOffsets[i], m_strokes + m_keyOffsets[i+1]},
+		{m_text + m_textOffsets[i], m_text + m_textOffsets[i+1]},
+	};
+}
+
+bool MappedDictionary::valid() const {
+	auto const& h = *m_header;
+	if (std::memcmp(h.magic, BinaryHeader::Magic, sizeof h.magic) != 0) return false;
+	if (h.version != BinaryHeader::CurrentVersion) return false;
+	if (h.byteOrder != BinaryHeader::ByteOrderMark) return false;
+
+	auto const inBounds = [&] (uint64_t offset, uint64_t bytes) {
+		return offset % Alignment == 0 && offset <= m_length && bytes <= m_length - offset;
+	};
+	if (!inBounds(h.keyOffsets, (h.entries + 1ull) * 4)) return false;
+	if (!inBounds(h.strokeData, h.strokes * 4ull)) return false;
+	if (!inBounds(h.textOffsets, (h.entries + 1ull) * 4)) return false;
+	if (!inBounds(h.textData, h.textBytes)) return false;
+	if (!inBounds(h.index, h.indexSize * 8ull)) return false;
+	if (h.indexSize & (h.indexSize - 1)) return false;
+
+	if (!validOffsets(m_keyOffsets, h.entries, h.strokes)) return false;
+	if (!validOffsets(m_textOffsets, h.entries, h.textBytes)) return false;
+	// Probes stop at an empty slot, so a table without room to spare would
+	// never end a search for a missing phrase. Ours are at most half full.
+	if (h.indexSize && h.indexSize < 2ull * h.entries) return false;
+	bool empty = false;
+	for (uint32_t i=0; i<h.indexSize; i++) {
+		if (m_index[i] == EmptySlot) empty = true;
+		else if (slotPosition(m_index[i]) >= h.entries) return false;
+	}
+	return empty || h.indexSize == 0;
+}
+
+} // namespace steno
@@ -0,0 +1,117 @@
+#pragma once
+#include "steno.hh"
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace steno {
+
+// A compiled dictionary, laid out so that it can be mapped straight into
+// memory and searched where it lies. After a fixed-size header come
+// these sections, each aligned to 8 bytes:
+//   keyOffsets   uint32[entries + 1]  Where each phrase starts in 'strokes'
+//   strokes      uint32[strokes]      Stroke::raw() of every phrase, in order
+//   textOffsets  uint32[entries + 1]  Where each text starts in 'text'
+//   text         char[textBytes]
+//   index        uint64[indexSize]    Optional, same slots as Dictionary's
+// Phrases are sorted the same way as in a Dictionary. Integers are stored
+// in the byte order of the machine that wrote them, which the header
+// records so a mismatch can be rejected rather than misread.
+struct BinaryHeader {
+	static constexpr char Magic[8] = {'S','T','E','N','O','D','I','C'};
+	static constexpr uint32_t CurrentVersion = 1;
+	static constexpr uint32_t ByteOrderMark = 0x01020304;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t entries;
+	uint32_t strokes;
+	uint32_t textBytes;
+	uint32_t indexSize;
+	uint64_t keyOffsets, strokeData, textOffsets, textData, index;
+};
+
+// Writes the dictionary out in the format above, with a hash index unless
+// asked not to. Fails if the stream does, or the dictionary is too big for
+// 32-bit offsets.
+bool writeBinary(std::ostream&, Dictionary const&, bool index = true);
+
+// One entry of a MappedDictionary, pointing into the mapped file.
+struct BriefView {
+	std::span<Stroke const> phrase;
+	std::string_view text;
+
+	operator Brief() const { return {Phrase {phrase}, text}; }
+};
+
+// Read-only view of a file written by writeBinary(). Opening it only maps
+// the file and checks that its sections are in bounds, nothing is parsed
+// or allocated per entry. Pages are read from disk as they are touched.
+class MappedDictionary {
+public:
+	class Iterator {
+		MappedDictionary const* m_dict = nullptr;
+		uint32_t m_position = 0;
+
+	public:
+		using value_type = BriefView;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() = default;
+		Iterator(MappedDictionary const* d, uint32_t i)
+		:	m_dict{d}, m_position{i} {}
+
+		BriefView operator*() const { return m_dict->entry(m_position); }
+		Iterator& operator++() { m_position++; return *this; }
+		Iterator operator++(int) { auto old = *this; ++*this; return old; }
+		bool operator==(Iterator const&) const = default;
+		difference_type operator-(Iterator const& other) const {
+			return difference_type(m_position) - other.m_position;
+		}
+	};
+
+	using value_type = BriefView;
+	using const_iterator = Iterator;
+	using size_type = std::size_t;
+
+	// Returns nothing if the file can't be mapped, or isn't in this format.
+	static std::optional<MappedDictionary> open(char const* path);
+
+	MappedDictionary(MappedDictionary&&);
+	MappedDictionary& operator=(MappedDictionary&&);
+	~MappedDictionary();
+
+	Iterator begin() const { return {this, 0}; }
+	// A moved-from MappedDictionary is empty.
+	Iterator end() const { return {this, uint32_t(size())}; }
+	std::size_t size() const { return m_header? m_header->entries: 0; }
+	bool empty() const { return size() == 0; }
+	bool indexed() const { return m_header && m_header->indexSize != 0; }
+
+	Iterator find(std::span<Stroke const>) const;
+	bool contains(std::span<Stroke const>) const;
+	std::string_view at(std::span<Stroke const>) const;
+	// Copies everything into an ordinary, modifiable Dictionary.
+	Dictionary toDictionary() const;
+
+private:
+	MappedDictionary(void const*, std::size_t);
+
+	void const* m_data = nullptr;
+	std::size_t m_length = 0;
+	BinaryHeader const* m_header = nullptr;
+	uint32_t const* m_keyOffsets = nullptr;
+	Stroke const* m_strokes = nullptr;
+	uint32_t const* m_textOffsets = nullptr;
+	char const* m_text = nullptr;
+	uint64_t const* m_index = nullptr;
+
+	BriefView entry(uint32_t) const;
+	bool valid() const;
+};
+
+static_assert(std::forward_iterator<MappedDictionary::Iterator>);
+
+} // namespace steno
@@ -1,34 +1,53 @@
 #include "steno_parsers.hh"
 #include <algorithm>
-#include <sstream>
+#include <iterator>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#	include <immintrin.h>
+#endif
 
 namespace steno {
 
+namespace /*detail*/ {
+	constexpr std::string_view RtfPrimer {R"({\*\cxs )"};
+
+	// The last entry runs on to the end of the document, taking its closing
+	// brace along. Anything from a '}' that closes no group is dropped.
+	std::string_view rtfEntryText(std::string_view text) {
+		int depth = 0;
+		for (std::size_t i=0; i<text.size(); i++) {
+			if (text[i] == '\\') i++;
+			else if (text[i] == '{') depth++;
+			else if (text[i] == '}' && --depth < 0) return text.substr(0, i);
+		}
+		return text;
+	}
+}
+
 template <>
 void EntryIterator<Plain>::next() {
-	if (!*input) finish();
-	else do {
-		std::string line {};
-		std::getline(*input, line);
-		if (std::all_of(line.begin(), line.end(), isWhitespace)) continue;
+	do {
+		// Blank lines are skipped, rather than handing out an entry again.
+		do if (!std::getline(*input, buffer)) { finish(); return; }
+		while (std::all_of(buffer.begin(), buffer.end(), isWhitespace));
+		std::string_view const line {buffer};
 		auto split = line.find('=');
 		if (split == line.npos) { fail(); return; }
-		current = Brief {
-			Phrase {line.substr(0, split)},
-			line.substr(split+1),
-		};
-	} while (!over() && current.failed());
+		current = Brief {Phrase (line.substr(0, split)), line.substr(split+1)};
+	} while (current.failed());
 }
 
 template <>
 void EntryIterator<Json>::next() {
-	auto parseString = [this] () -> std::string {
-		char c {}; std::string result {};
+	auto parseString = [this] (std::string& result) {
+		char c {}; result.clear();
 		while (input->get(c) && isWhitespace(c)) /**/;
-		if (c != '"') return {};
+		if (c != '"') return;
 		while (input->get(c)) {
 			if (c == '\\') {
-				if (!*input) { fail(); return {}; }
+				if (!*input) { fail(); return; }
 				char c = input->get();
 				/**/ if (c == 'b') result += '\b';
 				else if (c == 'f') result += '\f';
@@ -47,16 +66,16 @@ void EntryIterator<Json>::next() {
 			else if (c == '"') break;
 			else result += c;
 		}
-		return result;
 	};
 
 	do {
-		std::string stringL {}, stringR {};
+		Phrase phrase {};
 		enum { StrL, Colon, StrR, Accept } state {StrL};
 		while (*input && state != Accept) {
 			if (state == StrL) {
 				while (*input && input->peek() != '"') input->get();
-				stringL = parseString();
+				parseString(buffer);
+				phrase = Phrase (std::string_view {buffer});
 				state = Colon;
 			}
 			else if (state == Colon) {
@@ -67,88 +86,526 @@ void EntryIterator<Json>::next() {
 				}
 			}
 			else if (state == StrR) {
-				stringR = parseString();
+				parseString(buffer);
 				state = Accept;
 			}
 		}
-		current = Brief {Phrase {stringL}, stringR};
+		if (state != Accept) buffer.clear();
+		current = Brief {std::move(phrase), buffer};
 		if (input->eof()) finish();
 	} while (!over() && current.failed());
 }
 
 template <>
 void EntryIterator<Rtf>::next() {
-	static constexpr std::string_view primer {R"({\*\cxs )"};
 	if (state.value == RtfState::Header) {
 		unsigned count {0};
 		for (char c; input->get(c); /**/) {
-			if (count < primer.size()) {
-				if (c == primer[count]) count++;
+			if (count < RtfPrimer.size()) {
+				if (c == RtfPrimer[count]) count++;
 				else count = 0;
 			}
-			if (count == primer.size()) break;
+			if (count == RtfPrimer.size()) break;
 		}
+		state.value = RtfState::Body;
 	}
-	state.value = RtfState::Body;
 
 	if (state.value == RtfState::Final) finish();
 	else do {
-		std::string line {};
+		buffer.clear();
 		unsigned count {0};
 		for (char c; input->get(c); /**/) {
-			line += c;
-			if (count < primer.size()) {
-				if (c == primer[count]) count++;
+			buffer += c;
+			if (count < RtfPrimer.size()) {
+				if (c == RtfPrimer[count]) count++;
 				else count = 0;
 			}
-			if (count == primer.size()) break;
+			if (count == RtfPrimer.size()) break;
 		}
-		auto ending = line.size() - (over()? 0: primer.size());
+		std::string_view const line {buffer};
+		bool const last = (count != RtfPrimer.size());
+		auto ending = line.size() - (last? 0: RtfPrimer.size());
 		auto split = line.find('}');
 		if (split == line.npos) { fail(); return; }
 		current = Brief {
-			Phrase {line.substr(0, split)},
-			line.substr(split+1, ending - (split+1)),
+			Phrase (line.substr(0, split)),
+			rtfEntryText(line.substr(split+1, ending - (split+1))),
 		};
-		if (over()) state.value = RtfState::Final;
+		if (last) state.value = RtfState::Final;
 	} while (!over() && current.failed());
 }
 
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* ~~ Buffer Parsers ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
-std::optional<Dictionary> parseDictionary(ParserInput& input, FileType type) {
-	if (type != NoFileType) {
+namespace /*detail*/ {
+	// Where the next quote or backslash is, or 'n' if there are none.
+	// This is the only work to do inside a string, so it's done a vector
+	// at a time where the target allows.
+	std::size_t findQuoteOrEscape(char const* p, std::size_t n) {
+		std::size_t i = 0;
+#if defined(__AVX2__)
+		auto const quote = _mm256_set1_epi8('"'), escape = _mm256_set1_epi8('\\');
+		for (; i + 32 <= n; i += 32) {
+			auto const v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + i));
+			auto const mask = uint32_t(_mm256_movemask_epi8(_mm256_or_si256(
+				_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, escape)
+			)));
+			if (mask) return i + __builtin_ctz(mask);
+		}
+#endif
+#if defined(__SSE2__)
+		auto const quote16 = _mm_set1_epi8('"'), escape16 = _mm_set1_epi8('\\');
+		for (; i + 16 <= n; i += 16) {
+			auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+			auto const mask = uint32_t(_mm_movemask_epi8(_mm_or_si128(
+				_mm_cmpeq_epi8(v, quote16), _mm_cmpeq_epi8(v, escape16)
+			)));
+			if (mask) return i + __builtin_ctz(mask);
+		}
+#endif
+		for (; i < n; i++) if (p[i] == '"' || p[i] == '\\') return i;
+		return n;
+	}
+
+	constexpr bool isWhitespace(char c) {
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+}
+
+template <>
+bool BufferParser<Plain>::next() {
+	while (m_position < m_input.size()) {
+		auto end = m_input.find('\n', m_position);
+		if (end == m_input.npos) end = m_input.size();
+		auto const line = m_input.substr(m_position, end - m_position);
+		m_position = std::min(end + 1, m_input.size());
+		if (std::all_of(line.begin(), line.end(), isWhitespace)) continue;
+		auto const split = line.find('=');
+		if (split == line.npos) { m_failed = true; return false; }
+		m_phrase = line.substr(0, split);
+		m_text = line.substr(split+1);
+		return true;
+	}
+	return false;
+}
+
+// Reads up to the closing quote, assuming the opening one is behind us.
+template <>
+bool BufferParser<Json>::readString(std::string_view& out, std::string& scratch) {
+	auto const start = m_position;
+	bool escaped = false;
+	while (true) {
+		auto const rest = m_input.substr(m_position);
+		auto const i = findQuoteOrEscape(rest.data(), rest.size());
+		if (i == rest.size()) { m_failed = true; return false; }
+		if (escaped) scratch.append(rest.data(), i);
+		m_position += i + 1;
+		if (rest[i] == '"') break;
+
+		// Only now that there's an escape do we need a copy.
+		if (!escaped) scratch.assign(m_input.data() + start, m_position-1 - start);
+		escaped = true;
+		if (m_position == m_input.size()) { m_failed = true; return false; }
+		char const c = m_input[m_position++];
+		/**/ if (c == 'b') scratch += '\b';
+		else if (c == 'f') scratch += '\f';
+		else if (c == 'n') scratch += '\n';
+		else if (c == 'r') scratch += '\r';
+		else if (c == 't') scratch += '\t';
+		else if (c == 'u') {
+			/* TODO: UTF-8 encoding */
+			// Kept as it is, the same as EntryIterator<Json>.
+			auto const hex = m_input.substr(m_position, 4);
+			scratch += hex;
+			m_position += hex.size();
+		}
+		else scratch += c;
+	}
+	if (escaped) out = scratch;
+	else out = m_input.substr(start, m_position-1 - start);
+	return true;
+}
+
+template <>
+void BufferParser<Json>::skipWhitespace() {
+	while (m_position < m_input.size() && isWhitespace(m_input[m_position])) {
+		m_position++;
+	}
+}
+
+// Accepts the same input as EntryIterator<Json>, to the same result.
+template <>
+bool BufferParser<Json>::next() {
+	m_phrase = m_text = {};
+	auto const quote = m_input.find('"', m_position);
+	if (quote == m_input.npos) return false;
+	m_position = quote + 1;
+	if (!readString(m_phrase, m_phraseScratch)) return false;
+
+	skipWhitespace();
+	if (m_position == m_input.size() || m_input[m_position] != ':') {
+		m_failed = true;
+		return false;
+	}
+	m_position++;
+	skipWhitespace();
+	if (m_position == m_input.size()) return false;
+	// Anything but a string is taken as empty text.
+	if (m_input[m_position++] != '"') return true;
+	return readString(m_text, m_textScratch);
+}
+
+template <>
+bool BufferParser<Rtf>::next() {
+	// Everything up to the first entry is header.
+	if (m_position == 0) {
+		auto const first = m_input.find(RtfPrimer);
+		if (first == m_input.npos) { m_failed = true; return false; }
+		m_position = first + RtfPrimer.size();
+	}
+	if (m_position >= m_input.size()) return false;
+
+	auto end = m_input.find(RtfPrimer, m_position);
+	if (end == m_input.npos) end = m_input.size();
+	auto const entry = m_input.substr(m_position, end - m_position);
+	m_position = std::min(end + RtfPrimer.size(), m_input.size());
+	auto const split = entry.find('}');
+	if (split == entry.npos) { m_failed = true; return false; }
+	m_phrase = entry.substr(0, split);
+	m_text = rtfEntryText(entry.substr(split+1));
+	return true;
+}
+
+namespace /*detail*/ {
+	// Appends every entry that parses, stopping at the first error.
+	template <FileType FT>
+	bool parseEntries(std::string_view buffer, std::vector<Brief>& entries) {
+		BufferParser<FT> parser {buffer};
+		while (parser.next()) {
+			// Parentheses, or the view would make a one-stroke initializer list.
+			Brief brief {Phrase (parser.phrase()), parser.text()};
+			if (!brief.failed()) entries.push_back(std::move(brief));
+		}
+		return !parser.failed();
+	}
+
+	bool parseEntries(std::string_view buffer, FileType type, std::vector<Brief>& entries) {
+		if (type == Plain) return parseEntries<Plain>(buffer, entries);
+		if (type == Json) return parseEntries<Json>(buffer, entries);
+		if (type == Rtf) return parseEntries<Rtf>(buffer, entries);
+		return false;
+	}
+
+	// The first place at or after 'from' that an entry must start, judging
+	// only by what's nearby.
+	std::size_t nextBoundary(std::string_view buffer, FileType type, std::size_t from) {
 		if (type == Plain) {
-			EntryIterator<Plain> begin {input}, end {};
-			if (begin == end) return {};
-			return Dictionary {begin, end};
+			auto const i = buffer.find('\n', from);
+			if (i != buffer.npos) return i+1;
 		}
+		// Strings can't hold a raw newline, so any newline is between
+		// tokens, and after a comma it can only be followed by a key.
 		if (type == Json) {
-			EntryIterator<Json> begin {input}, end {};
-			if (begin == end) return {};
-			return Dictionary {begin, end};
+			for (auto i = buffer.find('\n', from); i != buffer.npos; i = buffer.find('\n', i+1)) {
+				if (i == 0) continue;
+				auto const before = buffer.find_last_not_of(" \t\r", i-1);
+				if (before != buffer.npos && buffer[before] == ',') return i+1;
+			}
 		}
 		if (type == Rtf) {
-			EntryIterator<Rtf> begin {input}, end {};
-			if (begin == end) return {};
-			return Dictionary {begin, end};
-		}
-	}
-	// In order to guess the file type we lose the luxury of being able to
-	// iterate our data as it comes in. There's probably an advanced solution
-	// which uses the first 100 or so bytes to determine the winning file type
-	// and processes the (potentially ginormous) rest of the file that way.
-	else {
-		std::istreambuf_iterator<char> begin {input}, end {};
-		std::string entireFile {begin, end};
-		for (auto guess : {Rtf, Json, Plain}) {
-			std::istringstream iss {entireFile};
-			if (auto result = parseDictionary(iss, guess)) {
-				return result;
+			auto const i = buffer.find(RtfPrimer, from);
+			if (i != buffer.npos) return i;
+		}
+		return buffer.size();
+	}
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+Detection detectFileType(std::string_view prefix) {
+	prefix = prefix.substr(0, DetectionPrefix);
+	Detection result {};
+	if (prefix.starts_with("\xEF\xBB\xBF")) result.skip = 3;
+	auto const start = prefix.find_first_not_of(" \t\r\n", result.skip);
+	if (start == prefix.npos) return result;
+	auto const rest = prefix.substr(start);
+
+	auto const found = [&] (FileType type, bool certain) {
+		result.type = type;
+		result.confidence = certain? Detection::Certain: Detection::Likely;
+		return result;
+	};
+	if (rest.starts_with("{\\rtf")) return found(Rtf, true);
+	if (rest.starts_with("{\\")) return found(Rtf, false);
+	if (rest.starts_with('{')) {
+		auto const next = rest.find_first_not_of(" \t\r\n", 1);
+		if (next == rest.npos) return found(Json, false);
+		if (rest[next] == '"' || rest[next] == '}') return found(Json, true);
+		return result;
+	}
+	// Plain text has no header, but its first entry has to be a key = value.
+	auto const line = rest.find('\n');
+	auto const split = rest.find('=');
+	if (split < line) return found(Plain, line != rest.npos);
+	return result;
+}
+
+namespace /*detail*/ {
+	// Hands back the bytes already read for detection, then carries on
+	// reading from the original stream in blocks.
+	class ReplayBuffer : public std::streambuf {
+		std::string m_prefix;
+		std::streambuf* m_rest;
+		char m_block[1 << 14];
+
+	public:
+		ReplayBuffer(std::string prefix, std::size_t skip, std::streambuf* rest)
+		:	m_prefix{std::move(prefix)}, m_rest{rest} {
+			setg(m_prefix.data(), m_prefix.data() + skip, m_prefix.data() + m_prefix.size());
+		}
+
+	protected:
+		int_type underflow() override {
+			if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+			auto const n = m_rest? m_rest->sgetn(m_block, sizeof m_block): 0;
+			if (n <= 0) return traits_type::eof();
+			setg(m_block, m_block, m_block + n);
+			return traits_type::to_int_type(*gptr());
+		}
+	};
+}
+
+std::optional<Dictionary> parseDictionary(ParserInput& input, FileType type) {
+	if (type == Plain) {
+		EntryIterator<Plain> begin {input}, end {};
+		if (begin == end) return {};
+		return Dictionary {std::make_move_iterator(begin), std::make_move_iterator(end)};
+	}
+	if (type == Json) {
+		EntryIterator<Json> begin {input}, end {};
+		if (begin == end) return {};
+		return Dictionary {std::make_move_iterator(begin), std::make_move_iterator(end)};
+	}
+	if (type == Rtf) {
+		EntryIterator<Rtf> begin {input}, end {};
+		if (begin == end) return {};
+		return Dictionary {std::make_move_iterator(begin), std::make_move_iterator(end)};
+	}
+	Detection detection {};
+	return parseDictionary(input, detection);
+}
+
+std::optional<Dictionary> parseDictionary(ParserInput& input, Detection& detection) {
+	std::string prefix (DetectionPrefix, '\0');
+	input.read(prefix.data(), prefix.size());
+	prefix.resize(input.gcount());
+	detection = detectFileType(prefix);
+	if (detection.type == NoFileType) return {};
+
+	ReplayBuffer buffer {std::move(prefix), detection.skip, input.rdbuf()};
+	std::istream replay {&buffer};
+	return parseDictionary(replay, detection.type);
+}
+
+std::optional<Dictionary> parseDictionary(std::string_view buffer, FileType type) {
+	if (type == NoFileType) {
+		auto const detection = detectFileType(buffer);
+		buffer.remove_prefix(detection.skip);
+		type = detection.type;
+	}
+	std::vector<Brief> entries {};
+	parseEntries(buffer, type, entries);
+	if (entries.empty()) return {};
+	auto first = std::make_move_iterator(entries.begin());
+	auto last  = std::make_move_iterator(entries.end());
+	return Dictionary {first, last};
+}
+
+std::optional<Dictionary> parseDictionaryParallel(
+	std::string_view buffer, FileType type, unsigned threads
+) {
+	if (type == NoFileType) {
+		auto const detection = detectFileType(buffer);
+		if (detection.type == NoFileType) return {};
+		buffer.remove_prefix(detection.skip);
+		type = detection.type;
+	}
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	// Below this, a thread isn't worth starting.
+	constexpr std::size_t MinimumChunk = 1 << 16;
+	std::size_t const count = std::clamp<std::size_t>(buffer.size() / MinimumChunk, 1, threads);
+
+	// The first chunk takes any header, so must reach the first entry.
+	std::size_t start = 0, earliest = 1;
+	if (type == Rtf) earliest = std::min(buffer.find(RtfPrimer), buffer.size()) + 1;
+	std::vector<std::string_view> chunks {};
+	for (std::size_t i=1; i<count; i++) {
+		auto const target = std::max(earliest, i * buffer.size() / count);
+		auto const boundary = nextBoundary(buffer, type, target);
+		if (boundary >= buffer.size()) break;
+		chunks.push_back(buffer.substr(start, boundary - start));
+		start = earliest = boundary;
+	}
+	chunks.push_back(buffer.substr(start));
+
+	struct Result { std::vector<Brief> entries {}; bool ok = true; };
+	std::vector<Result> results (chunks.size());
+	{
+		std::vector<std::jthread> workers {};
+		for (std::size_t i=1; i<chunks.size(); i++) {
+			workers.emplace_back([&, i] {
+				results[i].ok = parseEntries(chunks[i], type, results[i].entries);
+			});
+		}
+		results[0].ok = parseEntries(chunks[0], type, results[0].entries);
+	}
+
+	// Everything up to the first error, exactly as a single parse would.
+	std::size_t total = 0;
+	for (auto const& result : results) total += result.entries.size();
+	std::vector<Brief> entries {};
+	entries.reserve(total);
+	for (auto& result : results) {
+		std::move(result.entries.begin(), result.entries.end(), std::back_inserter(entries));
+		if (!result.ok) break;
+	}
+	if (entries.empty()) return {};
+	auto first = std::make_move_iterator(entries.begin());
+	auto last  = std::make_move_iterator(entries.end());
+	return Dictionary {first, last};
+}
+
+/* ~~ Writing ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+namespace /*detail*/ {
+	// Collects output into large blocks, so the stream is written to
+	// rarely and never a character at a time.
+	class OutputBuffer {
+		static constexpr std::size_t BlockSize = 1 << 16;
+		std::ostream& m_output;
+		std::string m_block {};
+
+	public:
+		OutputBuffer(std::ostream& os)
+		:	m_output{os} { m_block.reserve(BlockSize + Stroke::KeyCount + 1); }
+		~OutputBuffer() { flush(); }
+
+		void put(char c) { m_block += c; }
+		void put(std::string_view s) {
+			if (m_block.size() + s.size() > BlockSize) flush();
+			if (s.size() > BlockSize) m_output.write(s.data(), s.size());
+			else m_block += s;
+		}
+		void put(Phrase const& p) {
+			char buffer[Stroke::KeyCount];
+			for (int i=0; auto stroke : p) {
+				if (m_block.size() > BlockSize) flush();
+				if (i++) m_block += '/';
+				m_block.append(buffer, formatTo(buffer, stroke));
+			}
+		}
+		bool flush() {
+			m_output.write(m_block.data(), m_block.size());
+			m_block.clear();
+			return bool(m_output);
+		}
+	};
+
+	// The readers don't decode \u escapes, so the only control characters
+	// that can be written are those with an escape of their own.
+	bool jsonWritable(std::string_view text) {
+		return std::none_of(text.begin(), text.end(), [] (unsigned char c) {
+			return c < 0x20 && std::string_view {"\b\f\n\r\t"}.find(c) == std::string_view::npos;
+		});
+	}
+
+	// Escapes just what JSON requires, leaving the rest as UTF-8.
+	void putJsonString(OutputBuffer& out, std::string_view s) {
+		out.put('"');
+		for (std::size_t i=0; i<s.size(); /**/) {
+			std::size_t const plain = std::find_if(s.begin() + i, s.end(), [] (unsigned char c) {
+				return c < 0x20 || c == '"' || c == '\\';
+			}) - s.begin();
+			out.put(s.substr(i, plain - i));
+			if (plain == s.size()) break;
+			char const c = s[plain];
+			/**/ if (c == '"' ) out.put("\\\"");
+			else if (c == '\\') out.put("\\\\");
+			else if (c == '\b') out.put("\\b");
+			else if (c == '\f') out.put("\\f");
+			else if (c == '\n') out.put("\\n");
+			else if (c == '\r') out.put("\\r");
+			else if (c == '\t') out.put("\\t");
+			i = plain + 1;
+		}
+		out.put('"');
+	}
+
+	// RTF entries are read with their markup kept as text, so they are
+	// written back as they are. That only works if the markup keeps its
+	// groups closed, and can't be mistaken for the start of an entry.
+	bool rtfWritable(std::string_view text) {
+		if (text.find(RtfPrimer) != text.npos) return false;
+		int depth = 0;
+		for (std::size_t i=0; i<text.size(); i++) {
+			if (text[i] == '\\') { if (++i == text.size()) return false; }
+			else if (text[i] == '{') depth++;
+			else if (text[i] == '}' && --depth < 0) return false;
+		}
+		return depth == 0;
+	}
+}
+
+bool writeDictionary(std::ostream& os, Dictionary const& dict, FileType type) {
+	if (type == NoFileType) return false;
+	OutputBuffer out {os};
+	bool complete = true;
+
+	if (type == Plain) for (auto const& entry : dict) {
+		if (entry.text().find_first_of("\r\n") != entry.text().npos) {
+			complete = false;
+			continue;
+		}
+		out.put(entry.phrase());
+		out.put(" = ");
+		out.put(entry.text());
+		out.put('\n');
+	}
+
+	if (type == Json) {
+		// The layout Plover itself writes.
+		out.put(dict.empty()? "{": "{\n");
+		for (int i=0; auto const& entry : dict) {
+			if (!jsonWritable(entry.text())) {
+				complete = false;
+				continue;
+			}
+			if (i++) out.put(",\n");
+			out.put('"');
+			out.put(entry.phrase());
+			out.put("\": ");
+			putJsonString(out, entry.text());
+		}
+		out.put(dict.empty()? "}\n": "\n}\n");
+	}
+
+	if (type == Rtf) {
+		out.put("{\\rtf1\\ansi{\\*\\cxrev100}\\cxdict{\\*\\cxsystem steno}");
+		out.put("{\\stylesheet{\\s0 Normal;}}\n");
+		for (auto const& entry : dict) {
+			if (!rtfWritable(entry.text())) {
+				complete = false;
+				continue;
 			}
+			out.put(RtfPrimer);
+			out.put(entry.phrase());
+			out.put('}');
+			out.put(entry.text());
+			out.put('\n');
 		}
+		out.put("}\n");
 	}
-	return {};
+	return out.flush() && complete;
 }
 
 } // namespace steno
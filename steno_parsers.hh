@@ -2,6 +2,8 @@
 #include "steno.hh"
 #include <iostream>
 #include <optional>
+#include <string>
+#include <string_view>
 
 namespace steno {
 
@@ -15,7 +17,8 @@ enum FileType {
 template <FileType FT>
 class EntryIterator {
 	ParserInput* input {};
-	Brief current {};
+	mutable Brief current {}; // Mutable for iter_move()
+	std::string buffer {};    // Reused, so entries only allocate their own
 
 	struct PlainState {};
 	struct JsonState {};
@@ -32,6 +35,10 @@ class EntryIterator {
 public:
 	using value_type = Brief;
 	using difference_type = std::ptrdiff_t;
+	// Copies share the stream, so the standard library mustn't take it for
+	// a forward iterator and go through it twice.
+	using iterator_concept = std::forward_iterator_tag;
+	using iterator_category = std::input_iterator_tag;
 
 	EntryIterator()
 	:	input{nullptr} {}
@@ -43,7 +50,9 @@ public:
 		return this->over() && other.over();
 	}
 
-	Brief operator*() const { return current; }
+	Brief const& operator*() const { return current; }
+	// Lets std::move_iterator take the entry rather than copy it.
+	friend Brief&& iter_move(EntryIterator const& it) { return std::move(it.current); }
 	EntryIterator& operator++() { next(); return *this; }
 
 	EntryIterator operator++(int) {
@@ -75,6 +84,65 @@ static_assert(std::forward_iterator<EntryIterator<Plain>>);
 static_assert(std::forward_iterator<EntryIterator<Json>>);
 static_assert(std::forward_iterator<EntryIterator<Rtf>>);
 
+// Parses a dictionary held entirely in memory, such as a mapped file.
+// Strings are handed out as views into the buffer, except where they had
+// escapes to undo; those are kept in scratch space instead. Either way a
+// view only lasts until the next call to next().
+template <FileType FT>
+class BufferParser {
+	std::string_view m_input;
+	std::size_t m_position = 0;
+	std::string_view m_phrase {}, m_text {};
+	std::string m_phraseScratch {}, m_textScratch {};
+	bool m_failed = false;
+
+public:
+	BufferParser(std::string_view in)
+	:	m_input{in} {}
+
+	// Moves on to the next entry, if there is one and it parses.
+	bool next();
+	bool failed() const { return m_failed; }
+	std::string_view phrase() const { return m_phrase; }
+	std::string_view text() const { return m_text; }
+
+private:
+	bool readString(std::string_view&, std::string&);
+	void skipWhitespace();
+};
+
+// A guess at a file's type from its first few bytes.
+struct Detection {
+	FileType type = NoFileType;
+	enum Confidence {
+		None,    // Nothing recognisable
+		Likely,  // Only the start of a format, the prefix ran out
+		Certain, // A marker no other format could have
+	} confidence = None;
+	// Bytes to skip before parsing, for a byte order mark.
+	std::size_t skip = 0;
+};
+
+// No more than this much of the input is looked at to decide its type.
+constexpr std::size_t DetectionPrefix = 4096;
+Detection detectFileType(std::string_view prefix);
+
+// Without a FileType, only the first DetectionPrefix bytes are held back to
+// decide on one; the rest streams through that parser as it's read.
 std::optional<Dictionary> parseDictionary(ParserInput&, FileType=NoFileType);
+std::optional<Dictionary> parseDictionary(ParserInput&, Detection&);
+std::optional<Dictionary> parseDictionary(std::string_view, FileType=NoFileType);
+
+// Splits the buffer where an entry is sure to begin, and parses the pieces
+// on separate threads, all of the machine's by default. The result is the
+// same as from parseDictionary().
+std::optional<Dictionary> parseDictionaryParallel(
+	std::string_view, FileType, unsigned threads = 0
+);
+
+// Writes the dictionary out so that its parser reads back the same. An
+// entry the format can't hold, like text over several lines in a Plain
+// file, is left out and makes this return false, as does a failed stream.
+bool writeDictionary(std::ostream&, Dictionary const&, FileType);
 
 } // namespace steno
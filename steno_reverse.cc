@@ -0,0 +1,349 @@
+#include "steno_reverse.hh"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <utility>
+
+namespace steno {
+
+namespace /*detail*/ {
+	uint64_t textHash(std::string_view text) {
+		return std::hash<std::string_view> {} (text);
+	}
+
+	uint32_t slotTag(uint64_t hash) { return hash >> 32; }
+
+}
+
+/* ~~ Building ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+ReverseIndex::ReverseIndex(Dictionary const& dictionary) {
+	// There are never more texts than entries, so the table is sized once
+	// and stays at most half full.
+	m_slots.resize(std::bit_ceil(std::max<std::size_t>(dictionary.size() * 2, 2)));
+
+	// The word each entry belongs to, then how many entries each word has.
+	std::vector<uint32_t> wordOf {};
+	wordOf.reserve(dictionary.size());
+	for (auto const& entry : dictionary) {
+		std::string_view const text = entry.text();
+		auto const hash = textHash(text);
+		auto const i = probe(text, hash);
+		if (m_slots[i] == 0) {
+			m_slots[i] = uint64_t {slotTag(hash)} << 32 | (m_words.size() + 1);
+			m_words.push_back({
+				uint32_t (m_text.size()), uint32_t (text.size()), 0, 0
+			});
+			m_text += text;
+		}
+		auto const word = uint32_t (m_slots[i]) - 1;
+		m_words[word].last++;
+		wordOf.push_back(word);
+	}
+
+	// Counting sort by word, which keeps dictionary order within each.
+	uint32_t total = 0;
+	for (auto& word : m_words) {
+		word.first = total;
+		total += word.last;
+		word.last = word.first;
+	}
+	// Each entry goes in with its difficulty, so ranking doesn't work it
+	// out again for every comparison. Entries are in dictionary order, so
+	// their addresses break ties.
+	std::vector<std::pair<uint64_t, Brief const*>> ranked (total);
+	auto entry = dictionary.begin();
+	for (auto const word : wordOf) {
+		ranked[m_words[word].last++] = {difficulty(entry->phrase()), std::to_address(entry)};
+		++entry;
+	}
+	m_candidates.reserve(total);
+	for (auto const& word : m_words) {
+		std::sort(ranked.begin() + word.first, ranked.begin() + word.last);
+	}
+	for (auto const& [rank, candidate] : ranked) m_candidates.push_back(candidate);
+}
+
+// Orders the same as (strokes, keys, asterisks) for any real phrase, and
+// for sums of many thousands of them.
+uint64_t ReverseIndex::difficulty(std::span<Stroke const> phrase) {
+	uint64_t keys = 0, asterisks = 0;
+	for (auto stroke : phrase) {
+		keys += std::popcount(stroke.raw() >> Stroke::PadCount);
+		asterisks += stroke.get(Key::x);
+	}
+	return uint64_t {phrase.size()} << 40 | keys << 16 | asterisks;
+}
+
+/* ~~ Lookup ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+std::span<Brief const* const> ReverseIndex::find(std::string_view text) const {
+	if (m_slots.empty()) return {};
+	auto const slot = m_slots[probe(text, textHash(text))];
+	if (slot == 0) return {};
+	auto const& word = m_words[uint32_t (slot) - 1];
+	return {m_candidates.data() + word.first, m_candidates.data() + word.last};
+}
+
+Brief const* ReverseIndex::best(std::string_view text) const {
+	auto const candidates = find(text);
+	return candidates.empty()? nullptr: candidates.front();
+}
+
+// Internal
+// Where the text is in the table, or the empty slot it would go in.
+uint32_t ReverseIndex::probe(std::string_view text, uint64_t hash) const {
+	auto const mask = m_slots.size() - 1;
+	auto i = hash & mask;
+	for (;; i = (i+1) & mask) {
+		auto const slot = m_slots[i];
+		if (slot == 0) break;
+		if (slot >> 32 != slotTag(hash)) continue;
+		auto const& word = m_words[uint32_t (slot) - 1];
+		if (std::string_view {m_text}.substr(word.text, word.length) == text) break;
+	}
+	return i;
+}
+
+/* ~~ Reverse Translator ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+namespace /*detail*/ {
+	constexpr uint32_t NoToken = UINT32_MAX;
+	constexpr uint32_t NoNode = 0; // Never anyone's child
+	constexpr uint64_t Unreached = UINT64_MAX;
+	// Leaving a token as it is costs more than any entry could.
+	constexpr uint64_t UntranslatedCost = uint64_t {256} << 40;
+}
+
+ReverseTranslator::ReverseTranslator(Dictionary const& dictionary) {
+	m_nodes.push_back({});
+	for (auto const& entry : dictionary) {
+		std::string_view text = entry.text();
+		uint32_t node = 0;
+		std::size_t depth = 0;
+		while (!text.empty()) {
+			auto const end = std::min(text.find(' '), text.size());
+			auto const token = text.substr(0, end);
+			text.remove_prefix(std::min(end + 1, text.size()));
+			if (token.empty()) continue;
+
+			auto id = m_tokenIds.find(token);
+			if (id == m_tokenIds.end()) {
+				id = m_tokenIds.emplace(std::string {token}, m_tokenIds.size()).first;
+			}
+			auto const [child, added] = m_children.try_emplace(
+				uint64_t {node} << 32 | id->second, m_nodes.size()
+			);
+			if (added) m_nodes.push_back({});
+			node = child->second;
+			depth++;
+		}
+		if (depth == 0) continue;
+
+		m_depth = std::max(m_depth, depth);
+		auto const cost = ReverseIndex::difficulty(entry.phrase());
+		auto& n = m_nodes[node];
+		if (!n.entry || cost < n.cost) n = {&entry, cost};
+	}
+	m_best.push_back({0, 0, nullptr});
+}
+
+std::span<ReverseTranslator::Segment const> ReverseTranslator::push(std::string_view token) {
+	discardSettled();
+	auto const id = m_tokenIds.find(token);
+	m_tokens.push_back({
+		id == m_tokenIds.end()? NoToken: id->second,
+		uint32_t (m_text.size()), uint32_t (token.size())
+	});
+	m_text += token;
+	m_best.push_back({Unreached, 0, nullptr});
+
+	// A position can be tried once every token its entries could cover is
+	// in, as the cheapest way to it is known by then.
+	while (m_expanded < m_tokens.size() && m_expanded + m_depth <= m_tokens.size()) expand();
+	return m_output;
+}
+
+std::span<ReverseTranslator::Segment const> ReverseTranslator::finish() {
+	discardSettled();
+	// The last position is always settled, as nothing reaches beyond it.
+	while (m_expanded < m_tokens.size()) expand();
+	return m_output;
+}
+
+// Internal
+uint32_t ReverseTranslator::child(uint32_t node, uint32_t token) const {
+	if (token == NoToken) return NoNode;
+	auto const it = m_children.find(uint64_t {node} << 32 | token);
+	return it == m_children.end()? NoNode: it->second;
+}
+
+// Tries every entry starting at the next position, keeping any that make
+// a cheaper way to where they end.
+void ReverseTranslator::expand() {
+	auto const from = m_expanded++;
+	auto const base = m_best[from].cost;
+	auto const relax = [&] (std::size_t to, uint64_t cost, Brief const* entry) {
+		if (base + cost >= m_best[to].cost) return;
+		m_best[to] = {base + cost, uint32_t (from), entry};
+		m_reach = std::max(m_reach, to);
+	};
+	relax(from + 1, UntranslatedCost, nullptr);
+	uint32_t node = 0;
+	for (auto i=from; i<m_tokens.size(); i++) {
+		node = child(node, m_tokens[i].id);
+		if (node == NoNode) break;
+		if (auto const& n = m_nodes[node]; n.entry) relax(i + 1, n.cost, n.entry);
+	}
+
+	// When nothing reaches past the next position, every way on from here
+	// goes through it, so the way to it is final.
+	auto const next = from + 1;
+	if (m_reach <= next || next - m_settled >= pendingLimit) settle(next);
+}
+
+void ReverseTranslator::settle(std::size_t position) {
+	auto const first = m_output.size();
+	for (auto i=position; i>m_settled; i=m_best[i].from) {
+		auto const& best = m_best[i];
+		if (best.entry) m_output.push_back({best.entry, best.entry->text()});
+		else {
+			auto const& token = m_tokens[i - 1];
+			m_output.push_back({nullptr, std::string_view {m_text}.substr(token.text, token.length)});
+		}
+	}
+	std::reverse(m_output.begin() + first, m_output.end());
+
+	// Only when settled early will anything have crossed the position,
+	// and the ways on from here have to start again without it.
+	for (auto i=position+1; i<m_best.size(); i++) {
+		if (m_best[i].from < position) m_best[i] = {Unreached, 0, nullptr};
+	}
+	m_reach = std::max(m_reach, position);
+	m_settled = position;
+}
+
+// Drops what the last call handed out, once the caller is done with it.
+void ReverseTranslator::discardSettled() {
+	m_output.clear();
+	auto const p = m_settled;
+	if (p == 0) return;
+
+	auto const textStart = p < m_tokens.size()? m_tokens[p].text: m_text.size();
+	m_text.erase(0, textStart);
+	m_tokens.erase(m_tokens.begin(), m_tokens.begin() + p);
+	for (auto& token : m_tokens) token.text -= textStart;
+
+	auto const base = m_best[p].cost;
+	m_best.erase(m_best.begin(), m_best.begin() + p);
+	for (auto& best : m_best) {
+		if (best.cost == Unreached) continue;
+		best.cost -= base;
+		best.from -= p;
+	}
+	m_best.front() = {0, 0, nullptr};
+	m_expanded -= p;
+	m_reach -= p;
+	m_settled = 0;
+}
+
+/* ~~ Text Tokenizer ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+namespace /*detail*/ {
+	constexpr std::size_t TokenizerBlock = 1 << 16;
+
+	bool isContinuation(unsigned char c) { return (c & 0xC0) == 0x80; }
+	bool isAsciiLetter(unsigned char c) { return unsigned ((c | 0x20) - 'a') < 26; }
+	bool isAsciiSpace(unsigned char c) { return c == ' ' || unsigned (c - '\t') < 5; }
+}
+
+TextTokenizer::TextTokenizer(std::istream& input)
+:	m_input{input.rdbuf()}, m_buffer(TokenizerBlock, '\0') {}
+
+std::optional<std::string_view> TextTokenizer::next() {
+	auto unit = peek();
+	while (unit.kind == Kind::Space && unit.length) {
+		m_position += unit.length;
+		unit = peek();
+	}
+	if (unit.length == 0) return std::nullopt;
+
+	m_token.clear();
+	if (unit.kind != Kind::Letter) {
+		std::string_view const c {m_buffer.data() + m_position, unit.length};
+		m_position += unit.length;
+		if (c == "." || c == "?" || c == "!") m_sentenceStart = true;
+		m_token += '{';
+		m_token += c;
+		m_token += '}';
+		return m_token;
+	}
+
+	// Apostrophes only belong to a word with letters on both sides.
+	for (;;) {
+		// Runs of plain letters, the usual case, go in all at once.
+		auto run = m_position;
+		while (run < m_end && isAsciiLetter(m_buffer[run])) run++;
+		if (run != m_position) {
+			m_token.append(m_buffer, m_position, run - m_position);
+			m_position = run;
+			unit = peek();
+		}
+		if (unit.kind == Kind::Letter) m_token.append(m_buffer, m_position, unit.length);
+		else if (unit.kind == Kind::Apostrophe && peek(unit.length).kind == Kind::Letter) m_token += '\'';
+		else break;
+		m_position += unit.length;
+		unit = peek();
+	}
+	if (m_sentenceStart) {
+		char& first = m_token.front();
+		if (first >= 'A' && first <= 'Z') first += 'a' - 'A';
+		m_sentenceStart = false;
+	}
+	return m_token;
+}
+
+// Internal
+// What the character so far ahead is, without taking it. Its length is
+// zero at the end of the input, and one for a byte that isn't valid UTF-8.
+TextTokenizer::Unit TextTokenizer::peek(std::size_t offset) {
+	if (!fill(offset + 4) && m_end - m_position <= offset) return {Kind::Space, 0};
+	auto const* c = reinterpret_cast<unsigned char const*>(m_buffer.data() + m_position + offset);
+	auto const available = m_end - m_position - offset;
+
+	if (c[0] < 0x80) {
+		if (isAsciiSpace(c[0])) return {Kind::Space, 1};
+		if (isAsciiLetter(c[0])) return {Kind::Letter, 1};
+		return {c[0] == '\''? Kind::Apostrophe: Kind::Other, 1};
+	}
+	std::size_t const expected = c[0] >= 0xF0? 4: c[0] >= 0xE0? 3: c[0] >= 0xC0? 2: 1;
+	std::size_t length = 1;
+	while (length < std::min(expected, available) && isContinuation(c[length])) length++;
+	if (length != expected) return {Kind::Other, 1};
+
+	if (length == 2 && c[0] == 0xC2 && c[1] == 0xA0) return {Kind::Space, 2};
+	if (length == 3 && c[0] == 0xE2 && c[1] == 0x80) switch (c[2]) {
+		case 0x99: return {Kind::Apostrophe, 3};
+		case 0x93: case 0x94: // Dashes
+		case 0x98: case 0x9C: case 0x9D: // Quotes
+		case 0xA6: return {Kind::Other, 3}; // Ellipsis
+	}
+	return {Kind::Letter, length};
+}
+
+// Makes sure there are at least so many bytes after the position, if the
+// input has them, reading another block when there aren't.
+bool TextTokenizer::fill(std::size_t wanted) {
+	if (m_end - m_position >= wanted) return true;
+	std::copy(m_buffer.begin() + m_position, m_buffer.begin() + m_end, m_buffer.begin());
+	m_end -= m_position;
+	m_position = 0;
+	while (m_input && m_end < wanted) {
+		auto const read = m_input->sgetn(m_buffer.data() + m_end, m_buffer.size() - m_end);
+		if (read <= 0) m_input = nullptr;
+		else m_end += read;
+	}
+	return m_end >= wanted;
+}
+
+} // namespace steno
@@ -0,0 +1,157 @@
+#pragma once
+#include "steno.hh"
+#include <istream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace steno {
+
+// Looks up the phrases that write a given text, the other way round from
+// a Dictionary. Built in one pass, after which each lookup is a single
+// probe of a flat hash table and never allocates. Each distinct text is
+// stored once, and its phrases are ranked when the index is built, the
+// easiest to write first.
+// Nothing changes after construction, so any number of threads may query
+// it at once. The Dictionary must outlive the index and not change.
+class ReverseIndex {
+public:
+	ReverseIndex() = default;
+	ReverseIndex(Dictionary const&);
+
+	// Every entry with exactly this text, best first.
+	std::span<Brief const* const> find(std::string_view) const;
+	// The first of those, or nullptr when there are none.
+	Brief const* best(std::string_view) const;
+	bool contains(std::string_view t) const { return !find(t).empty(); }
+	// The number of distinct texts.
+	std::size_t size() const { return m_words.size(); }
+	bool empty() const { return m_words.empty(); }
+
+	// How phrases with the same text are ranked, lowest first: by strokes,
+	// then keys, then asterisks, with dictionary order breaking ties. The
+	// scores of several phrases add up to rank them together.
+	static uint64_t difficulty(std::span<Stroke const>);
+
+private:
+	struct Word {
+		uint32_t text, length; // Within m_text
+		uint32_t first, last;  // Within m_candidates
+	};
+	std::string m_text {};
+	std::vector<Word> m_words {};
+	std::vector<Brief const*> m_candidates {};
+	// Each slot packs the high half of the text's hash next to one more
+	// than the word's position, leaving zero for an empty slot.
+	std::vector<uint64_t> m_slots {};
+
+	uint32_t probe(std::string_view, uint64_t hash) const;
+};
+
+// Turns text back into strokes, a token at a time, choosing the entries
+// that write it in the fewest strokes overall. Entries may span several
+// tokens ("as well as"), so each split of the text into entries is a path
+// and the cheapest is found by dynamic programming. Tokens are held back
+// only until no entry can reach across them, which for ordinary text is
+// every few words, so memory stays bounded whatever the length of input.
+// Entry texts are split into tokens at spaces, so the caller's tokens
+// must follow suit. The Dictionary must outlive the translator.
+class ReverseTranslator {
+public:
+	// One piece of the translation: an entry covering one or more tokens,
+	// or a single token nothing covers, with a null entry.
+	struct Segment {
+		Brief const* entry;
+		std::string_view text; // The entry's text, or else the token
+	};
+
+	ReverseTranslator(Dictionary const&);
+
+	// Feeds in the next token. Returns the segments it settled, which are
+	// only valid until the next call.
+	std::span<Segment const> push(std::string_view token);
+	// Settles everything left over, ready to start again.
+	std::span<Segment const> finish();
+
+	// The most tokens in any entry, and so how far ahead it has to look.
+	std::size_t lookahead() const { return m_depth; }
+	// Most tokens to hold back, past which the best split so far is taken
+	// as it stands. Only text with no gaps between entries reaches it.
+	std::size_t pendingLimit = 4096;
+
+private:
+	// Entry texts form a trie, one level per token, with the root at 0.
+	struct Node {
+		Brief const* entry = nullptr; // The easiest entry ending here
+		uint64_t cost = 0;
+	};
+	std::vector<Node> m_nodes {};
+	std::unordered_map<uint64_t, uint32_t> m_children {}; // parent<<32 | token
+	std::size_t m_depth = 0;
+	struct TextHash {
+		using is_transparent = void;
+		std::size_t operator()(std::string_view s) const
+		{ return std::hash<std::string_view> {} (s); }
+	};
+	std::unordered_map<std::string, uint32_t, TextHash, std::equal_to<>> m_tokenIds {};
+
+	// The pending tokens, and for each position between them the cheapest
+	// way there from the last settled position.
+	struct Token {
+		uint32_t id;
+		uint32_t text, length; // Within m_text
+	};
+	struct Best {
+		uint64_t cost;
+		uint32_t from;
+		Brief const* entry;
+	};
+	std::vector<Token> m_tokens {};
+	std::string m_text {};
+	std::vector<Best> m_best {};
+	std::size_t m_expanded = 0; // Positions whose entries have been tried
+	std::size_t m_reach = 0;    // The furthest position those reach
+	std::size_t m_settled = 0;  // Positions handed out, to drop next call
+	std::vector<Segment> m_output {};
+
+	uint32_t child(uint32_t node, uint32_t token) const;
+	void expand();
+	void settle(std::size_t position);
+	void discardSettled();
+};
+
+// Splits running text into tokens as ReverseTranslator expects them: each
+// word, taking in apostrophes within it ("don't"), or else a single other
+// character in braces ("{,}"), the way dictionaries write punctuation.
+// The first word of each sentence is lowercased. Reads the stream a block
+// at a time, so a book goes through without being held in memory whole.
+// Anything outside ASCII counts as a letter, apart from curly quotes and
+// dashes, and the curly apostrophe is written as a plain one within words.
+class TextTokenizer {
+public:
+	TextTokenizer(std::istream&);
+
+	// The next token, only valid until the next call, or nothing at the
+	// end of the input.
+	std::optional<std::string_view> next();
+
+private:
+	std::streambuf* m_input;
+	std::string m_buffer;
+	std::size_t m_position = 0, m_end = 0;
+	std::string m_token {};
+	bool m_sentenceStart = true;
+
+	enum class Kind { Space, Letter, Apostrophe, Other };
+	struct Unit {
+		Kind kind;
+		std::size_t length;
+	};
+	Unit peek(std::size_t offset = 0);
+	bool fill(std::size_t wanted);
+};
+
+} // namespace steno
@@ -0,0 +1,214 @@
+#include "steno_shared.hh"
+#include <algorithm>
+#include <utility>
+
+namespace steno {
+
+namespace /*detail*/ {
+	bool strokesLess(std::span<Stroke const> a, std::span<Stroke const> b) {
+		return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+	}
+
+	// Where the phrase is or would be in a list sorted by strokesLess().
+	auto removedPosition(std::vector<Phrase> const& removed, std::span<Stroke const> s) {
+		return std::lower_bound(removed.begin(), removed.end(), s,
+			[] (Phrase const& p, std::span<Stroke const> s) { return strokesLess(p, s); }
+		);
+	}
+
+	bool isRemoved(std::vector<Phrase> const& removed, std::span<Stroke const> s) {
+		auto const it = removedPosition(removed, s);
+		return it != removed.end() && std::ranges::equal(*it, s);
+	}
+}
+
+/* ~~ Reading ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Each thread reads through a slot of its own, holding the epoch it began
+// reading in above a count of the snapshots using it. A version replaced in
+// some epoch can be freed once every slot in use began after that epoch.
+struct SharedDictionary::ReadSlot {
+	static constexpr unsigned CountBits = 20;
+	static constexpr uint64_t CountMask = (uint64_t {1} << CountBits) - 1;
+
+	alignas(64) std::atomic<uint64_t> state {0};
+	std::atomic<bool> owned {true};
+	ReadSlot* next = nullptr;
+};
+
+namespace /*detail*/ {
+	using ReadSlot = SharedDictionary::ReadSlot;
+
+	// Moves on each time any SharedDictionary replaces a version.
+	std::atomic<uint64_t> epoch {1};
+	// Every slot ever made, never freed, but taken over when a thread exits.
+	std::atomic<ReadSlot*> slots {nullptr};
+
+	ReadSlot* claimSlot() {
+		for (auto* s = slots.load(std::memory_order_acquire); s; s = s->next) {
+			bool owned = false;
+			if (!s->owned.load(std::memory_order_relaxed)
+			&&  s->owned.compare_exchange_strong(owned, true)) return s;
+		}
+		auto* s = new ReadSlot {};
+		s->next = slots.load(std::memory_order_relaxed);
+		while (!slots.compare_exchange_weak(s->next, s, std::memory_order_release)) {}
+		return s;
+	}
+
+	struct SlotOwner {
+		ReadSlot* slot = claimSlot();
+		~SlotOwner() { slot->owned.store(false, std::memory_order_release); }
+	};
+
+	ReadSlot& threadSlot() {
+		thread_local SlotOwner const owner {};
+		return *owner.slot;
+	}
+
+	// Until unpin(), no version current from now on is freed. Only the
+	// first of a thread's snapshots sets the epoch; the rest keep it.
+	void pin(ReadSlot& slot) {
+		auto state = slot.state.load(std::memory_order_relaxed);
+		uint64_t next;
+		do next = (state & ReadSlot::CountMask)? state + 1
+		:   epoch.load() << ReadSlot::CountBits | 1;
+		while (!slot.state.compare_exchange_weak(state, next));
+	}
+
+	void unpin(ReadSlot& slot) {
+		slot.state.fetch_sub(1, std::memory_order_release);
+	}
+
+	// The earliest epoch a reader might still be in.
+	uint64_t oldestReader() {
+		uint64_t result = UINT64_MAX;
+		for (auto* s = slots.load(std::memory_order_acquire); s; s = s->next) {
+			auto const state = s->state.load();
+			if (state & ReadSlot::CountMask) result = std::min(result, state >> ReadSlot::CountBits);
+		}
+		return result;
+	}
+}
+
+SharedDictionary::Snapshot::Snapshot(Snapshot const& other)
+:	m_version{other.m_version}, m_slot{other.m_slot} {
+	if (m_slot) pin(*m_slot);
+}
+
+SharedDictionary::Snapshot::Snapshot(Snapshot&& other)
+:	m_version{other.m_version}, m_slot{std::exchange(other.m_slot, nullptr)} {}
+
+SharedDictionary::Snapshot& SharedDictionary::Snapshot::operator=(Snapshot other) {
+	std::swap(m_version, other.m_version);
+	std::swap(m_slot, other.m_slot);
+	return *this;
+}
+
+SharedDictionary::Snapshot::~Snapshot() {
+	if (m_slot) unpin(*m_slot);
+}
+
+Brief const* SharedDictionary::Snapshot::find(std::span<Stroke const> s) const {
+	return m_version->find(s);
+}
+
+Dictionary SharedDictionary::Snapshot::toDictionary() const {
+	return m_version->toDictionary();
+}
+
+SharedDictionary::Snapshot SharedDictionary::snapshot() const {
+	auto& slot = threadSlot();
+	pin(slot);
+	return {m_current.load(), &slot};
+}
+
+/* ~~ Versions ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+Brief const* SharedDictionary::Version::find(std::span<Stroke const> s) const {
+	if (auto it = added.find(s); it != added.end()) return std::to_address(it);
+	if (isRemoved(removed, s)) return nullptr;
+	if (auto it = base->find(s); it != base->end()) return std::to_address(it);
+	return nullptr;
+}
+
+Dictionary SharedDictionary::Version::toDictionary() const {
+	Dictionary result {};
+	result.reserve(size);
+	for (auto const& entry : *base) {
+		if (!isRemoved(removed, entry.phrase())) result.insert(entry);
+	}
+	result.insert(added.begin(), added.end());
+	return result;
+}
+
+/* ~~ Writing ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+SharedDictionary::SharedDictionary(Dictionary dictionary)
+:	m_current{nullptr} {
+	auto const size = dictionary.size();
+	auto base = std::make_shared<Dictionary const>(std::move(dictionary));
+	publish(std::make_unique<Version const>(Version {std::move(base), {}, {}, size}));
+}
+
+SharedDictionary::~SharedDictionary() {
+	delete m_current.load();
+}
+
+void SharedDictionary::apply(std::span<Edit const> edits) {
+	std::scoped_lock const lock {m_writing};
+	// Only writers free versions, so the current one can't go anywhere.
+	auto next = std::make_unique<Version>(*m_current.load(std::memory_order_relaxed));
+	auto& base = *next->base;
+
+	for (auto const& edit : edits) {
+		bool const inBase = base.contains(edit.phrase);
+		bool const wasPresent = next->added.contains(edit.phrase)
+		||  (inBase && !isRemoved(next->removed, edit.phrase));
+		auto const removed = removedPosition(next->removed, edit.phrase);
+		bool const tombstone = removed != next->removed.end() && *removed == edit.phrase;
+
+		if (edit.text) {
+			next->added[edit.phrase] = *edit.text;
+			if (tombstone) next->removed.erase(removed);
+			next->size += !wasPresent;
+		}
+		else {
+			next->added.erase(edit.phrase);
+			if (inBase && !tombstone) next->removed.insert(removed, edit.phrase);
+			next->size -= wasPresent;
+		}
+	}
+
+	// Fold the overlay into a new base once it stops being small.
+	auto const limit = std::max(MinimumOverlay, base.size() / overlayDivisor);
+	if (next->added.size() + next->removed.size() > limit) {
+		next->base = std::make_shared<Dictionary const>(next->toDictionary());
+		next->added.clear();
+		next->removed.clear();
+	}
+	publish(std::move(next));
+}
+
+void SharedDictionary::insert(Brief const& b) {
+	Edit const edits[] = {{b.phrase(), b.text()}};
+	apply(edits);
+}
+
+void SharedDictionary::erase(Phrase const& p) {
+	Edit const edits[] = {{p}};
+	apply(edits);
+}
+
+// Internal
+void SharedDictionary::publish(std::unique_ptr<Version const> next) {
+	// Everything here is sequentially consistent: a reader that pinned
+	// after the epoch moved on is sure to load the new version.
+	std::unique_ptr<Version const> old {m_current.exchange(next.release())};
+	if (!old) return;
+	m_retired.emplace_back(std::move(old), epoch.fetch_add(1));
+	auto const oldest = oldestReader();
+	std::erase_if(m_retired, [&] (auto const& r) { return r.second < oldest; });
+}
+
+} // namespace steno
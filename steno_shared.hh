@@ -0,0 +1,96 @@
+#pragma once
+#include "steno.hh"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace steno {
+
+// A dictionary read from many threads while one at a time edits it.
+// Readers take a snapshot and look things up in it without locking; it
+// won't change however long they keep it. Taking one is a single atomic
+// load of the current version, after the thread marks itself as reading
+// in a slot of its own, so readers never write to anything they share.
+// Writers publish a whole new version, so a batch of edits shows up all
+// at once. The old version is freed once no slot could still be reading
+// it, so a snapshot held for long keeps every version since alive.
+// A version shares its large base with the one before, and only copies a
+// small overlay of the edits made since. When the overlay grows past a
+// threshold it is folded into a new base.
+class SharedDictionary {
+	struct Version {
+		std::shared_ptr<Dictionary const> base;
+		Dictionary added {};
+		std::vector<Phrase> removed {}; // Sorted, only phrases in base
+		std::size_t size = 0;
+
+		Brief const* find(std::span<Stroke const>) const;
+		Dictionary toDictionary() const;
+	};
+
+public:
+	// Where a thread marks the oldest version it may be reading.
+	struct ReadSlot;
+
+	// An immutable view of the dictionary at one point in time. It must
+	// not outlive the SharedDictionary it was taken from.
+	class Snapshot {
+		Version const* m_version;
+		ReadSlot* m_slot;
+
+		friend SharedDictionary;
+		Snapshot(Version const* v, ReadSlot* s)
+		:	m_version{v}, m_slot{s} {}
+
+	public:
+		Snapshot(Snapshot const&);
+		Snapshot(Snapshot&&);
+		Snapshot& operator=(Snapshot);
+		~Snapshot();
+
+		// Entries stay valid for as long as the snapshot is kept.
+		Brief const* find(std::span<Stroke const>) const;
+		bool contains(std::span<Stroke const> s) const { return find(s); }
+		std::size_t size() const { return m_version->size; }
+		bool empty() const { return size() == 0; }
+		// Copies everything into an ordinary, modifiable Dictionary.
+		Dictionary toDictionary() const;
+	};
+
+	// One change to the dictionary: no text means erase the phrase.
+	struct Edit {
+		Phrase phrase;
+		std::optional<Text> text {};
+	};
+
+	SharedDictionary(Dictionary = {});
+	SharedDictionary(SharedDictionary const&) = delete;
+	SharedDictionary& operator=(SharedDictionary const&) = delete;
+	~SharedDictionary();
+
+	// Lock-free, though cheaper still to keep for a batch of lookups.
+	Snapshot snapshot() const;
+	// Takes effect for every snapshot taken after it returns.
+	void apply(std::span<Edit const>);
+	void insert(Brief const&);
+	void erase(Phrase const&);
+
+	// Most edits to keep in an overlay, as a fraction of the base's size.
+	// There is always room for at least MinimumOverlay.
+	std::size_t overlayDivisor = 64;
+	static constexpr std::size_t MinimumOverlay = 1024;
+
+private:
+	std::atomic<Version const*> m_current;
+	std::mutex m_writing {};
+	// Replaced versions, with the epoch they were replaced in.
+	std::vector<std::pair<std::unique_ptr<Version const>, uint64_t>> m_retired {};
+
+	void publish(std::unique_ptr<Version const>);
+};
+
+} // namespace steno
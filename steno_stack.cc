@@ -0,0 +1,108 @@
+#include "steno_stack.hh"
+#include <algorithm>
+
+namespace steno {
+
+/* ~~ Layers ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+DictionaryStack::DictionaryStack(std::initializer_list<Dictionary> layers) {
+	for (auto const& dictionary : layers) push(dictionary);
+}
+
+DictionaryStack::Layer DictionaryStack::push(Dictionary dictionary) {
+	m_layers.push_back({std::move(dictionary)});
+	m_changedFrom.push_back(0);
+	m_moved.push_back(0);
+	changed(m_layers.size() - 1);
+	return m_layers.size() - 1;
+}
+
+void DictionaryStack::insert(Layer i, Brief const& b) {
+	auto& dictionary = m_layers[i].dictionary;
+	auto const size = dictionary.size();
+	dictionary[b.phrase()] = b.text();
+	// A new entry moves those after it; new text stays where it was.
+	if (dictionary.size() != size) moved(i);
+	forget(b.phrase());
+}
+
+void DictionaryStack::erase(Layer i, Phrase const& p) {
+	if (m_layers[i].dictionary.erase(p) == 0) return;
+	moved(i);
+	forget(p);
+}
+
+Dictionary& DictionaryStack::edit(Layer i) {
+	changed(i);
+	return m_layers[i].dictionary;
+}
+
+void DictionaryStack::enable(Layer i, bool enabled) {
+	if (m_layers[i].enabled == enabled) return;
+	m_layers[i].enabled = enabled;
+	changed(i);
+}
+
+// Internal
+void DictionaryStack::changed(Layer i) {
+	// Only what was found at or below this layer can be affected.
+	m_clock++;
+	for (Layer j=0; j<=i; j++) m_changedFrom[j] = m_clock;
+}
+
+void DictionaryStack::moved(Layer i) {
+	// Only what was found in this layer points into it.
+	m_moved[i] = ++m_clock;
+}
+
+void DictionaryStack::forget(std::span<Stroke const> s) {
+	if (auto it = m_cache.find(s); it != m_cache.end()) m_cache.erase(it);
+}
+
+/* ~~ Lookup ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+Brief const* DictionaryStack::find(std::span<Stroke const> s) const {
+	if (empty()) return nullptr;
+	return lookup(s).entry;
+}
+
+DictionaryStack::Layer DictionaryStack::layerOf(std::span<Stroke const> s) const {
+	if (empty()) return NoLayer;
+	auto const& cached = lookup(s);
+	return cached.entry? cached.layer: NoLayer;
+}
+
+Dictionary DictionaryStack::flatten() const {
+	Dictionary result {};
+	for (auto const& layer : m_layers) {
+		if (layer.enabled) result.insert(layer.dictionary.begin(), layer.dictionary.end());
+	}
+	return result;
+}
+
+// Internal
+DictionaryStack::Cached const& DictionaryStack::lookup(std::span<Stroke const> s) const {
+	auto it = m_cache.find(s);
+	if (it != m_cache.end()) {
+		auto const& [entry, layer, stamp] = it->second;
+		if (m_changedFrom[layer] <= stamp && (!entry || m_moved[layer] <= stamp)) {
+			return it->second;
+		}
+	}
+
+	Cached result {nullptr, 0, m_clock};
+	for (Layer i=m_layers.size(); i-- > 0; /**/) {
+		auto const& layer = m_layers[i];
+		if (!layer.enabled) continue;
+		auto const found = layer.dictionary.find(s);
+		if (found == layer.dictionary.end()) continue;
+		result = {std::to_address(found), i, m_clock};
+		break;
+	}
+
+	if (it != m_cache.end()) return it->second = result;
+	if (m_cache.size() >= cacheLimit) m_cache.clear();
+	return m_cache.emplace(Phrase (s), result).first->second;
+}
+
+} // namespace steno
@@ -0,0 +1,90 @@
+#pragma once
+#include "steno.hh"
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace steno {
+
+// Several dictionaries searched as one, the way Plover stacks a user's
+// dictionary over its main one: the top layer with an entry wins. Layers
+// are kept apart rather than merged, so changing one leaves the others
+// alone. Lookups are cached. Setting or erasing one entry only drops the
+// cached results for its phrase and any found in its layer, so editing a
+// small user dictionary keeps everything found in the large ones below.
+// Any other change drops every result that depends on the layer changed
+// (found in it, or below it).
+// Not safe to share between threads, not even for lookups, as they fill
+// the cache.
+class DictionaryStack {
+public:
+	// Layers are numbered from the bottom, in the order they were pushed.
+	using Layer = std::size_t;
+	static constexpr Layer NoLayer = -1;
+
+	DictionaryStack() = default;
+	DictionaryStack(std::initializer_list<Dictionary>);
+
+	// Adds a layer above all the others.
+	Layer push(Dictionary);
+	std::size_t size() const { return m_layers.size(); }
+	bool empty() const { return m_layers.empty(); }
+
+	Dictionary const& layer(Layer i) const { return m_layers[i].dictionary; }
+	// Adds the entry to a layer, or replaces the text it had there.
+	void insert(Layer, Brief const&);
+	void erase(Layer, Phrase const&);
+	// Every other edit has to go through here, so the cache knows of it.
+	// The reference is only for editing until the next lookup.
+	Dictionary& edit(Layer);
+
+	// Nothing is rebuilt, the layer is just skipped over.
+	void enable(Layer, bool = true);
+	void disable(Layer i) { enable(i, false); }
+	bool enabled(Layer i) const { return m_layers[i].enabled; }
+
+	// The entry from the highest enabled layer that has one.
+	Brief const* find(std::span<Stroke const>) const;
+	bool contains(std::span<Stroke const> s) const { return find(s); }
+	// Which layer find() took its entry from.
+	Layer layerOf(std::span<Stroke const>) const;
+	// Every enabled layer merged into one, for what needs a Dictionary.
+	Dictionary flatten() const;
+
+	// Limits the memory held by the cache, which starts over when full.
+	std::size_t cacheLimit = 1 << 16;
+
+private:
+	struct Entry {
+		Dictionary dictionary;
+		bool enabled = true;
+	};
+	// Moving a Dictionary keeps its entries where they are, so pointers
+	// into lower layers survive the vector growing.
+	std::vector<Entry> m_layers {};
+	// For each layer, the last time it or any layer above it was edited,
+	// enabled or disabled.
+	std::vector<uint64_t> m_changedFrom {};
+	// For each layer, the last time its entries moved in memory.
+	std::vector<uint64_t> m_moved {};
+	uint64_t m_clock = 0;
+
+	struct Cached {
+		Brief const* entry;
+		Layer layer;    // Where it was found, or 0 for not at all
+		uint64_t stamp; // The clock when it was looked up
+	};
+	struct PhraseEqual {
+		using is_transparent = void;
+		bool operator()(std::span<Stroke const> a, std::span<Stroke const> b) const
+		{ return std::ranges::equal(a, b); }
+	};
+	mutable std::unordered_map<Phrase, Cached, std::hash<Phrase>, PhraseEqual> m_cache {};
+
+	Cached const& lookup(std::span<Stroke const>) const;
+	void changed(Layer);
+	void moved(Layer);
+	void forget(std::span<Stroke const>);
+};
+
+} // namespace steno
@@ -0,0 +1,218 @@
+#include "steno_translator.hh"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace steno {
+
+/* ~~ Prefix Trie ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+PrefixTrie::PrefixTrie(Dictionary const& dictionary)
+:	m_entries{std::to_address(dictionary.begin())} {
+	uint32_t const size = dictionary.size();
+	m_nodes.push_back({0, 0, 0, size, false});
+	m_keys.push_back(0);
+
+	// Breadth first, so the children of each node are made side by side.
+	// A node at depth d covers the entries sharing its first d strokes;
+	// those continuing with the same stroke make up each child.
+	for (std::size_t i=0, depth=0, levelEnd=1; i<m_nodes.size(); i++) {
+		if (i == levelEnd) depth++, levelEnd = m_nodes.size();
+		auto node = m_nodes[i];
+		if (node.first < node.last) m_depth = std::max(m_depth, depth);
+
+		auto entry = node.first;
+		if (entry < node.last && m_entries[entry].phrase().size() == depth) {
+			m_nodes[i].exact = true;
+			entry++;
+		}
+		m_nodes[i].firstChild = m_nodes.size();
+		while (entry < node.last) {
+			Stroke const key = m_entries[entry].phrase()[depth];
+			auto const start = entry;
+			while (entry < node.last && m_entries[entry].phrase()[depth] == key) entry++;
+			m_nodes.push_back({0, 0, start, entry, false});
+			m_keys.push_back(key.raw());
+		}
+		m_nodes[i].childCount = m_nodes.size() - m_nodes[i].firstChild;
+	}
+
+	// The root has a child for nearly every stroke in use, too many to
+	// search quickly, so its keys are split up by their leading bits.
+	auto const& root = m_nodes[0];
+	uint32_t const top = root.childCount? m_keys[root.childCount]: 0;
+	// At most 31, as the number bar sets the top bit of a key.
+	while (m_rootShift < 31 && top >> m_rootShift >= std::max(root.childCount / 4, 1u)) m_rootShift++;
+	m_rootBuckets.resize((top >> m_rootShift) + 2);
+	for (uint32_t k=0, i=1; k<m_rootBuckets.size(); k++) {
+		while (i <= root.childCount && m_keys[i] >> m_rootShift < k) i++;
+		m_rootBuckets[k] = i;
+	}
+}
+
+PrefixTrie::Cursor PrefixTrie::child(Cursor c, Stroke s) const {
+	if (c == NoCursor) return NoCursor;
+	auto first = m_keys.begin(), last = m_keys.begin();
+	if (c == Root) {
+		auto const bucket = s.raw() >> m_rootShift;
+		if (bucket + 1 >= m_rootBuckets.size()) return NoCursor;
+		first += m_rootBuckets[bucket];
+		last += m_rootBuckets[bucket + 1];
+	}
+	else {
+		auto const& node = m_nodes[(uint32_t)c];
+		first += node.firstChild;
+		last = first + node.childCount;
+	}
+	auto const it = std::lower_bound(first, last, s.raw());
+	if (it == last || *it != s.raw()) return NoCursor;
+	return Cursor(it - m_keys.begin());
+}
+
+PrefixTrie::Cursor PrefixTrie::find(std::span<Stroke const> s) const {
+	Cursor c = Root;
+	for (auto stroke : s) c = child(c, stroke);
+	return c;
+}
+
+Brief const* PrefixTrie::entry(Cursor c) const {
+	if (c == NoCursor || !m_nodes[(uint32_t)c].exact) return nullptr;
+	return m_entries + m_nodes[(uint32_t)c].first;
+}
+
+std::span<Brief const> PrefixTrie::completions(Cursor c) const {
+	if (c == NoCursor) return {};
+	auto const& node = m_nodes[(uint32_t)c];
+	return {m_entries + node.first, m_entries + node.last};
+}
+
+std::span<Brief const> PrefixTrie::completions(std::span<Stroke const> s) const {
+	return completions(find(s));
+}
+
+bool PrefixTrie::hasLongerEntries(Cursor c) const {
+	return c != NoCursor && m_nodes[(uint32_t)c].childCount != 0;
+}
+
+bool PrefixTrie::hasLongerEntries(std::span<Stroke const> s) const {
+	return hasLongerEntries(find(s));
+}
+
+/* ~~ Translator ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+namespace /*detail*/ {
+	void prefetch([[maybe_unused]] void const* p) {
+#	if defined(__GNUC__)
+		__builtin_prefetch(p);
+#	endif
+	}
+}
+
+Translator::Translator(Dictionary const& dictionary, std::size_t undoLimit)
+:	m_trie{dictionary} {
+	// Anything shorter would cut off phrases before they can complete.
+	m_undoLimit = std::max(undoLimit, m_trie.depth());
+}
+
+Translator::Output Translator::translate(Stroke stroke) {
+	if (stroke == undoStroke) return undo();
+
+	// Carry on from where each previous translation this stroke could still
+	// join had got to. The oldest one that lands on an entry is the longest
+	// match; failing that, the stroke stands alone.
+	std::size_t joined = 0, total = 0;
+	// Each entry found is fetched while the walk goes on, as it's written
+	// out straight after.
+	PrefixTrie::Cursor matched = m_trie.child(PrefixTrie::Root, stroke);
+	Brief const* entry = m_trie.entry(matched);
+	prefetch(entry);
+	for (std::size_t i=0; i<m_history.size(); i++) {
+		auto& t = m_history[m_history.size() - 1 - i];
+		total += t.strokes.size();
+		if (total > m_trie.depth()) break;
+		t.cursor = m_trie.child(t.cursor, stroke);
+		if (auto const* found = m_trie.entry(t.cursor)) {
+			joined = i+1, matched = t.cursor, entry = found;
+			prefetch(entry);
+		}
+	}
+
+	Translation result {};
+	result.entry = entry;
+	result.cursor = matched;
+	result.replaced = joined;
+	for (auto it=m_history.end()-joined; it!=m_history.end(); ++it) {
+		result.strokes.insert(result.strokes.end(), it->strokes.begin(), it->strokes.end());
+	}
+	result.strokes.push_back(stroke);
+
+	// Take back the output of everything we joined.
+	Output output {};
+	auto const first = m_history.end() - result.replaced;
+	for (auto it=first; it!=m_history.end(); ++it) {
+		output.erase += it->length;
+		result.footprint += 1 + it->footprint;
+		m_replaced.push_back(std::move(*it));
+	}
+	m_history.erase(first, m_history.end());
+
+	m_text.clear();
+	write(result);
+	push(std::move(result));
+	output.text = m_text;
+	return output;
+}
+
+Translator::Output Translator::undo() {
+	if (m_history.empty()) return {};
+	Translation last = std::move(m_history.back());
+	m_history.pop_back();
+
+	// Bring back whatever the last translation had joined.
+	m_text.clear();
+	auto const first = m_replaced.end() - last.replaced;
+	for (auto it=first; it!=m_replaced.end(); ++it) {
+		write(*it);
+		m_history.push_back(std::move(*it));
+	}
+	m_replaced.erase(first, m_replaced.end());
+	recalculate();
+	return {last.length, m_text};
+}
+
+void Translator::clear() {
+	m_history.clear();
+	m_replaced.clear();
+}
+
+// Internal
+void Translator::write(Translation& t) {
+	auto const start = m_text.size();
+	m_text += ' ';
+	if (t.entry) m_text += t.entry->text();
+	else formatTo(std::back_inserter(m_text), t.strokes);
+	t.length = m_text.size() - start;
+}
+
+void Translator::push(Translation&& t) {
+	m_history.push_back(std::move(t));
+	while (m_history.size() > m_undoLimit) {
+		// Everything the oldest translation replaced sits at the front.
+		auto const footprint = m_history.front().footprint;
+		m_history.pop_front();
+		m_replaced.erase(m_replaced.begin(), m_replaced.begin() + footprint);
+	}
+}
+
+// Walk the trie afresh for every translation still within reach of the
+// next stroke, as after an undo their cursors may have moved on.
+void Translator::recalculate() {
+	m_scratch.clear();
+	for (auto it=m_history.rbegin(); it!=m_history.rend(); ++it) {
+		if (m_scratch.size() + it->strokes.size() > m_trie.depth()) break;
+		m_scratch.insert(m_scratch.begin(), it->strokes.begin(), it->strokes.end());
+		it->cursor = m_trie.find(m_scratch);
+	}
+}
+
+} // namespace steno
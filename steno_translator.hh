@@ -0,0 +1,102 @@
+#pragma once
+#include "steno.hh"
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace steno {
+
+// A read-only index over the phrases of a Dictionary, one trie level per
+// stroke. Every node is a prefix shared by some run of entries, which the
+// Dictionary keeps next to each other, so completions come out as a span.
+// Nothing changes after construction, so any number of threads may query
+// it at once. The Dictionary must outlive the trie and not change.
+class PrefixTrie {
+public:
+	// Handle to a node, for walking the trie one stroke at a time.
+	enum class Cursor : uint32_t {};
+	static constexpr Cursor Root {0};
+	static constexpr Cursor NoCursor {UINT32_MAX};
+
+	PrefixTrie(Dictionary const&);
+
+	Cursor child(Cursor, Stroke) const;
+	Cursor find(std::span<Stroke const>) const;
+	// The entry spelled exactly by this prefix, if there is one.
+	Brief const* entry(Cursor) const;
+	// All entries starting with this prefix, itself included.
+	std::span<Brief const> completions(Cursor) const;
+	std::span<Brief const> completions(std::span<Stroke const>) const;
+	bool hasLongerEntries(Cursor) const;
+	bool hasLongerEntries(std::span<Stroke const>) const;
+	// The most strokes in any phrase.
+	std::size_t depth() const { return m_depth; }
+
+private:
+	struct Node {
+		uint32_t firstChild = 0, childCount = 0;
+		uint32_t first = 0, last = 0; // Range of entries
+		bool exact = false; // Whether 'first' spells the prefix exactly
+	};
+	// Children of a node are adjacent, sorted by the stroke leading to
+	// them. Those strokes are kept apart from the nodes for searching.
+	std::vector<Node> m_nodes {};
+	std::vector<uint32_t> m_keys {};
+	// Where the root's children start for each value of the leading bits.
+	std::vector<uint32_t> m_rootBuckets {};
+	uint32_t m_rootShift = 0;
+	Brief const* m_entries = nullptr;
+	std::size_t m_depth = 0;
+};
+
+// Turns strokes into text as they arrive. Each stroke is joined with as
+// many of the previous translations as the dictionary has a phrase for,
+// longest match first, replacing whatever they had output on their own.
+// The Dictionary must outlive the Translator and not change while in use.
+class Translator {
+public:
+	// How to update the output after a stroke: remove the last 'erase'
+	// characters written so far, then write 'text'. The text view is only
+	// valid until the next call into the Translator.
+	struct Output {
+		std::size_t erase = 0;
+		std::string_view text {};
+	};
+
+	Translator(Dictionary const&, std::size_t undoLimit = 100);
+
+	Output translate(Stroke);
+	Output undo();
+	void clear();
+
+	// The longest phrase in the dictionary, and so the furthest back a
+	// stroke can reach to join previous translations.
+	std::size_t lookahead() const { return m_trie.depth(); }
+	Stroke undoStroke = Key::x;
+
+private:
+	struct Translation {
+		Phrase strokes {};
+		Brief const* entry = nullptr; // nullptr when untranslated
+		uint32_t length = 0;   // Characters of output
+		uint32_t replaced = 0; // Translations this one joined
+		uint32_t footprint = 0; // Entries in m_replaced it owns, recursively
+		// Where the strokes from this translation to the latest one lead.
+		PrefixTrie::Cursor cursor = PrefixTrie::NoCursor;
+	};
+
+	PrefixTrie m_trie;
+	std::size_t m_undoLimit;
+	std::deque<Translation> m_history {};
+	std::deque<Translation> m_replaced {};
+	// Reused between strokes to avoid allocating.
+	Phrase m_scratch {};
+	std::string m_text {};
+
+	void write(Translation&);
+	void push(Translation&&);
+	void recalculate();
+};
+
+} // namespace steno